@@ -0,0 +1,296 @@
+/**
+ * @file object_async_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief mutex that supports asynchronous lock by C++20 coroutine for obj_mutex::co_lock_get()
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_ASYNC_MUTEX_HPP_
+#define OBJECT_ASYNC_MUTEX_HPP_
+
+#if defined( __cpp_impl_coroutine ) && defined( __has_include )
+#if __has_include( <coroutine> )
+
+#include <condition_variable>
+#include <coroutine>
+#include <mutex>
+#include <utility>
+
+#include "object_mutex.hpp"
+
+namespace obj_mutex_impl {
+
+template <typename U, typename STORAGE_T, typename EXECUTOR_T>
+class async_lock_awaitable;
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief mutex that supports the asynchronous lock by C++20 coroutine
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<T, obj_async_mutex>.
+ * co_await obj_mutex::co_lock_get() suspends the coroutine without blocking any thread while other holds the lock.
+ * The waiters are queued in FIFO order by the intrusive list, and unlock() hands over the lock to the first waiter directly.
+ * Then the coroutine is resumed by the executor that is passed to co_lock_get().
+ *
+ * The executor is called by the loop of the outermost unlock() in the thread.
+ * If a coroutine that is resumed by this loop calls unlock(), e.g. by the destructor of single_accessor,
+ * unlock() hands over the lock and returns, and the loop resumes the next waiter after the coroutine suspends or finishes.
+ * Therefore the stack does not grow with the number of waiters even if inline_executor is used.
+ * As the result, the coroutine should not block the thread to wait for the waiter that is handed over the lock by it.
+ *
+ * lock_get() and with_lock() are also available. They block the thread, and are queued with the coroutines in the same FIFO.
+ */
+class obj_async_mutex {
+public:
+	/**
+	 * @brief executor that resumes the coroutine in the thread that calls unlock()
+	 */
+	struct inline_executor {
+		void operator()( std::coroutine_handle<> h ) const
+		{
+			h.resume();
+		}
+	};
+
+	template <typename U, typename STORAGE_T, typename EXECUTOR_T>
+	using lock_awaitable = obj_mutex_impl::async_lock_awaitable<U, STORAGE_T, EXECUTOR_T>;
+
+	obj_async_mutex( void )
+	  : state_mtx_()
+	  , locked_( false )
+	  , p_head_( nullptr )
+	  , p_tail_( nullptr )
+	{
+	}
+
+	void lock( void )
+	{
+		std::unique_lock<std::mutex> lk( state_mtx_ );
+		if ( !locked_ ) {
+			locked_ = true;
+			return;
+		}
+
+		std::condition_variable cv;
+		waiter_node             w { nullptr, &cv, false, nullptr, nullptr };
+		enqueue( &w );
+		cv.wait( lk, [&w]() { return w.granted_; } );
+	}
+
+	bool try_lock( void )
+	{
+		std::lock_guard<std::mutex> lk( state_mtx_ );
+		if ( locked_ ) {
+			return false;
+		}
+		locked_ = true;
+		return true;
+	}
+
+	void unlock( void )
+	{
+		std::unique_lock<std::mutex> lk( state_mtx_ );
+		waiter_node*                 p_w = dequeue();
+		if ( p_w == nullptr ) {
+			locked_ = false;
+			return;
+		}
+
+		// locked_はtrueのまま、先頭の待ち手にロックを引き渡す。
+		if ( p_w->p_cv_ != nullptr ) {
+			// 待ち手のスレッドはstate_mtx_を再取得するまでwを破棄できないため、notifyはロック中に行う。
+			p_w->granted_ = true;
+			p_w->p_cv_->notify_one();
+			return;
+		}
+		lk.unlock();
+		resume_in_loop( p_w );
+	}
+
+private:
+	obj_async_mutex( const obj_async_mutex& )            = delete;
+	obj_async_mutex& operator=( const obj_async_mutex& ) = delete;
+
+	struct waiter_node {
+		waiter_node*             p_next_;
+		std::condition_variable* p_cv_;   // not nullptr: the thread that is blocked by lock()
+		bool                     granted_;
+		void*                    p_owner_;   // owner of this node that is passed to p_resume_
+		void ( *p_resume_ )( void* );
+	};
+
+	void enqueue( waiter_node* p_w )
+	{
+		p_w->p_next_ = nullptr;
+		if ( p_tail_ == nullptr ) {
+			p_head_ = p_w;
+		} else {
+			p_tail_->p_next_ = p_w;
+		}
+		p_tail_ = p_w;
+	}
+
+	/**
+	 * @brief list of the waiters to resume, and whether the loop of resume_in_loop() runs in this thread
+	 */
+	struct resume_queue {
+		bool         is_running_;
+		waiter_node* p_head_;
+		waiter_node* p_tail_;
+	};
+
+	static resume_queue& get_resume_queue( void )
+	{
+		static thread_local resume_queue rq { false, nullptr, nullptr };
+		return rq;
+	}
+
+	/**
+	 * @brief resume the waiter, or append it to the loop that already runs in this thread
+	 *
+	 * p_w has been dequeued and handed over the lock, so p_next_ of it is reused for the list of resume_queue.
+	 */
+	static void resume_in_loop( waiter_node* p_w )
+	{
+		resume_queue& rq = get_resume_queue();
+		p_w->p_next_     = nullptr;
+		if ( rq.p_tail_ == nullptr ) {
+			rq.p_head_ = p_w;
+		} else {
+			rq.p_tail_->p_next_ = p_w;
+		}
+		rq.p_tail_ = p_w;
+		if ( rq.is_running_ ) {
+			return;   // 外側のループがresumeする。ここでresumeすると待ち手の数だけスタックが深くなる。
+		}
+
+		rq.is_running_ = true;
+		while ( rq.p_head_ != nullptr ) {
+			waiter_node* p_cur = rq.p_head_;
+			rq.p_head_         = p_cur->p_next_;
+			if ( rq.p_head_ == nullptr ) {
+				rq.p_tail_ = nullptr;
+			}
+			try {
+				p_cur->p_resume_( p_cur->p_owner_ );   // 以降、p_curは破棄されている可能性がある。
+			} catch ( ... ) {
+				// 残りの待ち手は、このスレッドの次のunlock()のループがresumeする。
+				rq.is_running_ = false;
+				throw;
+			}
+		}
+		rq.is_running_ = false;
+	}
+
+	waiter_node* dequeue( void )
+	{
+		waiter_node* p_ans = p_head_;
+		if ( p_ans != nullptr ) {
+			p_head_ = p_ans->p_next_;
+			if ( p_head_ == nullptr ) {
+				p_tail_ = nullptr;
+			}
+		}
+		return p_ans;
+	}
+
+	/**
+	 * @brief lock if not locked, or enqueue the waiter
+	 *
+	 * @return true the waiter is enqueued. the coroutine should be suspended.
+	 * @return false the lock is acquired.
+	 */
+	bool lock_or_enqueue( waiter_node* p_w )
+	{
+		std::lock_guard<std::mutex> lk( state_mtx_ );
+		if ( !locked_ ) {
+			locked_ = true;
+			return false;
+		}
+		enqueue( p_w );
+		return true;
+	}
+
+	std::mutex   state_mtx_;
+	bool         locked_;
+	waiter_node* p_head_;
+	waiter_node* p_tail_;
+
+	template <typename U, typename STORAGE_T, typename EXECUTOR_T>
+	friend class obj_mutex_impl::async_lock_awaitable;
+};
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief awaitable of obj_mutex::co_lock_get()
+ *
+ * co_await returns single_accessor, and the lock is released by the destructor of single_accessor as same as lock_get().
+ * This is not copyable and not movable, because the waiter node in this is linked to the queue of obj_async_mutex while the coroutine is suspended.
+ */
+template <typename U, typename STORAGE_T, typename EXECUTOR_T>
+class async_lock_awaitable {
+public:
+	using accessor_t    = single_accessor<U, obj_async_mutex, STORAGE_T>;
+	using carrier_ptr_t = typename storage_traits<STORAGE_T, obj_async_mutex>::carrier_ptr_t;
+
+	async_lock_awaitable( carrier_ptr_t sp_carrier_arg, obj_async_mutex& mtx_arg, U& ref_arg, EXECUTOR_T ex_arg )
+	  : node_ { nullptr, nullptr, false, this, &resume_by_executor }
+	  , sp_carrier_( std::move( sp_carrier_arg ) )
+	  , mtx_( mtx_arg )
+	  , ref_( ref_arg )
+	  , ex_( std::move( ex_arg ) )
+	  , h_()
+	{
+	}
+
+	bool await_ready( void )
+	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &mtx_ );
+		return mtx_.try_lock();
+	}
+
+	bool await_suspend( std::coroutine_handle<> h )
+	{
+		h_ = h;
+		return mtx_.lock_or_enqueue( &node_ );
+	}
+
+	accessor_t await_resume( void )
+	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &mtx_ );
+		return accessor_projector::adopt<U, obj_async_mutex, STORAGE_T>( std::unique_lock<obj_async_mutex>( mtx_, std::adopt_lock ), sp_carrier_, ref_ );
+	}
+
+private:
+	async_lock_awaitable( const async_lock_awaitable& )            = delete;
+	async_lock_awaitable& operator=( const async_lock_awaitable& ) = delete;
+
+	static void resume_by_executor( void* p_owner )
+	{
+		// executorがインラインでresumeした場合、このawaitableは破棄されるため、呼び出し前にローカルへ移す。
+		async_lock_awaitable*   p_this = static_cast<async_lock_awaitable*>( p_owner );
+		EXECUTOR_T              ex     = std::move( p_this->ex_ );
+		std::coroutine_handle<> h      = p_this->h_;
+		ex( h );
+	}
+
+	obj_async_mutex::waiter_node node_;
+	carrier_ptr_t                sp_carrier_;
+	obj_async_mutex&             mtx_;
+	U&                           ref_;
+	EXECUTOR_T                   ex_;
+	std::coroutine_handle<>      h_;
+};
+
+}   // namespace obj_mutex_impl
+
+#endif
+#endif
+
+#endif
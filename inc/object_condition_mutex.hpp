@@ -0,0 +1,175 @@
+/**
+ * @file object_condition_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief mutex wrapper with the condition variable for single_accessor::wait()
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_CONDITION_MUTEX_HPP_
+#define OBJECT_CONDITION_MUTEX_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+#include "object_mutex.hpp"
+
+/**
+ * @brief mutex wrapper that has the condition variable
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<std::deque<int>, obj_condition_mutex<>>.
+ * Because the mutex is placed in the carrier, the condition variable is also placed in the carrier, and is shared by shared_clone().
+ * single_accessor::wait(pred) waits on it, and obj_mutex::notify_one()/notify_all() wake up the waiters.
+ * obj_mutex with a plain mutex does not have any cost of this.
+ *
+ * If MTX_T is std::mutex, std::condition_variable is used. Otherwise std::condition_variable_any is used.
+ *
+ * @tparam MTX_T type of the underlying mutex. If MTX_T is SharedLockable or TimedLockable, this is also.
+ */
+template <typename MTX_T = std::mutex>
+class obj_condition_mutex {
+public:
+	using condition_variable_t = typename std::conditional<std::is_same<MTX_T, std::mutex>::value,
+	                                                       std::condition_variable,
+	                                                       std::condition_variable_any>::type;
+
+	obj_condition_mutex( void )
+	  : mtx_()
+	  , cv_()
+	{
+	}
+
+	void lock( void )
+	{
+		mtx_.lock();
+	}
+
+	bool try_lock( void )
+	{
+		return mtx_.try_lock();
+	}
+
+	void unlock( void )
+	{
+		mtx_.unlock();
+	}
+
+	template <typename Rep, typename Period, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	bool try_lock_for( const std::chrono::duration<Rep, Period>& timeout_duration )
+	{
+		return mtx_.try_lock_for( timeout_duration );
+	}
+
+	template <typename Clock, typename Duration, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	bool try_lock_until( const std::chrono::time_point<Clock, Duration>& timeout_time )
+	{
+		return mtx_.try_lock_until( timeout_time );
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	void lock_shared( void )
+	{
+		mtx_.lock_shared();
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	bool try_lock_shared( void )
+	{
+		return mtx_.try_lock_shared();
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	void unlock_shared( void )
+	{
+		mtx_.unlock_shared();
+	}
+
+	/**
+	 * @brief wait until pred returns true
+	 *
+	 * @param lk lock of this mutex. this should own the lock.
+	 * @param pred callable object that is callable as pred()
+	 */
+	template <typename PRED>
+	void wait( std::unique_lock<obj_condition_mutex>& lk, PRED pred )
+	{
+		underlying_lock ulk( *this, lk );
+		cv_.wait( ulk.lk_, pred );
+	}
+
+	/**
+	 * @brief wait until pred returns true or the timeout duration has elapsed
+	 *
+	 * @return the last result of pred
+	 */
+	template <typename Rep, typename Period, typename PRED>
+	bool wait_for( std::unique_lock<obj_condition_mutex>& lk, const std::chrono::duration<Rep, Period>& rel_time, PRED pred )
+	{
+		underlying_lock ulk( *this, lk );
+		return cv_.wait_for( ulk.lk_, rel_time, pred );
+	}
+
+	/**
+	 * @brief wait until pred returns true or the timeout time has been reached
+	 *
+	 * @return the last result of pred
+	 */
+	template <typename Clock, typename Duration, typename PRED>
+	bool wait_until( std::unique_lock<obj_condition_mutex>& lk, const std::chrono::time_point<Clock, Duration>& timeout_time, PRED pred )
+	{
+		underlying_lock ulk( *this, lk );
+		return cv_.wait_until( ulk.lk_, timeout_time, pred );
+	}
+
+	void notify_one( void ) noexcept
+	{
+		cv_.notify_one();
+	}
+
+	void notify_all( void ) noexcept
+	{
+		cv_.notify_all();
+	}
+
+private:
+	obj_condition_mutex( const obj_condition_mutex& )            = delete;
+	obj_condition_mutex& operator=( const obj_condition_mutex& ) = delete;
+
+	/**
+	 * @brief unique_lock of the underlying mutex that borrows the ownership from the lock of this wrapper while waiting
+	 *
+	 * The condition variable returns with the lock even if pred throws an exception. Therefore the ownership is always given back to the lock of this wrapper.
+	 */
+	struct underlying_lock {
+		underlying_lock( obj_condition_mutex& owner, std::unique_lock<obj_condition_mutex>& lk )
+		  : lk_( checked_mtx( owner, lk ), std::adopt_lock )
+		{
+		}
+
+		~underlying_lock()
+		{
+			lk_.release();
+		}
+
+		static MTX_T& checked_mtx( obj_condition_mutex& owner, std::unique_lock<obj_condition_mutex>& lk )
+		{
+			if ( !lk.owns_lock() || lk.mutex() != &owner ) {
+				throw std::logic_error( "obj_condition_mutex::wait() requires the lock of this mutex" );
+			}
+			return owner.mtx_;
+		}
+
+		std::unique_lock<MTX_T> lk_;
+	};
+
+	MTX_T                mtx_;
+	condition_variable_t cv_;
+};
+
+#endif
@@ -0,0 +1,344 @@
+/**
+ * @file object_elided_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief mutex wrapper that elides the lock by hardware transactional memory for obj_mutex
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_ELIDED_MUTEX_HPP_
+#define OBJECT_ELIDED_MUTEX_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "object_instrumented_mutex.hpp"
+#include "object_mutex.hpp"
+#include "object_spin_mutex.hpp"
+
+#if defined( __RTM__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <immintrin.h>
+#define OBJECT_MUTEX_HTM_RTM
+#elif defined( __ARM_FEATURE_TME )
+#include <arm_acle.h>
+#define OBJECT_MUTEX_HTM_TME
+#endif
+
+/**
+ * @brief snapshot of the statistics of obj_elided_mutex
+ *
+ * The committed transactions are not counted, because a shared counter that is updated by every commit causes the cache line traffic that the elision avoids.
+ * obj_mutex::stats() provides this for one mutex, and obj_mutex_stats_registry::for_each_elision() provides this for all alive obj_elided_mutex.
+ */
+struct obj_elision_stats {
+	const void*   id;                //!< identifier of the mutex. this is same while the mutex is alive.
+	std::uint64_t aborts;            //!< number of aborted transactions
+	std::uint64_t conflict_aborts;   //!< number of transactions that are aborted by the conflict with other thread
+	std::uint64_t capacity_aborts;   //!< number of transactions that are aborted by the overflow of the transactional buffer
+	std::uint64_t lock_busy_aborts;  //!< number of transactions that are aborted, because other thread holds the fallback lock
+	std::uint64_t fallbacks;         //!< number of acquisitions of the fallback lock
+};
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief thin wrapper of the intrinsics of hardware transactional memory
+ *
+ * begin() returns started if the transaction starts. Otherwise it returns the abort status.
+ * If the hardware transactional memory is not available at compile time or at run time, available() returns false and the other functions are not called.
+ */
+struct htm {
+#if defined( OBJECT_MUTEX_HTM_RTM )
+	using status_t                 = unsigned int;
+	static constexpr status_t started = _XBEGIN_STARTED;
+
+	static bool available( void ) noexcept
+	{
+		// __RTM__はコンパイラの指定であり、実行するCPUがRTMを持つとは限らない。TSXが無効化されたCPUもあるため、実行時に確認する。
+		static const bool is_available = __builtin_cpu_supports( "rtm" );
+		return is_available;
+	}
+	static status_t begin( void ) noexcept
+	{
+		return _xbegin();
+	}
+	static void end( void ) noexcept
+	{
+		_xend();
+	}
+	static void abort_lock_busy( void ) noexcept
+	{
+		_xabort( 0xff );
+	}
+	static bool is_retryable( status_t st ) noexcept
+	{
+		return ( st & _XABORT_RETRY ) != 0;
+	}
+	static bool is_conflict( status_t st ) noexcept
+	{
+		return ( st & _XABORT_CONFLICT ) != 0;
+	}
+	static bool is_capacity( status_t st ) noexcept
+	{
+		return ( st & _XABORT_CAPACITY ) != 0;
+	}
+	static bool is_lock_busy( status_t st ) noexcept
+	{
+		return ( ( st & _XABORT_EXPLICIT ) != 0 ) && ( _XABORT_CODE( st ) == 0xff );
+	}
+#elif defined( OBJECT_MUTEX_HTM_TME )
+	using status_t                 = std::uint64_t;
+	static constexpr status_t started = 0;
+
+	static bool available( void ) noexcept
+	{
+		return true;
+	}
+	static status_t begin( void ) noexcept
+	{
+		return __tstart();
+	}
+	static void end( void ) noexcept
+	{
+		__tcommit();
+	}
+	static void abort_lock_busy( void ) noexcept
+	{
+		__tcancel( 0xff );
+	}
+	static bool is_retryable( status_t st ) noexcept
+	{
+		return ( st & _TMFAILURE_RTRY ) != 0;
+	}
+	static bool is_conflict( status_t st ) noexcept
+	{
+		return ( st & _TMFAILURE_MEM ) != 0;
+	}
+	static bool is_capacity( status_t st ) noexcept
+	{
+		return ( st & _TMFAILURE_SIZE ) != 0;
+	}
+	static bool is_lock_busy( status_t st ) noexcept
+	{
+		return ( ( st & _TMFAILURE_CNCL ) != 0 ) && ( ( st & _TMFAILURE_REASON ) == 0xff );
+	}
+#else
+	using status_t                 = unsigned int;
+	static constexpr status_t started = 0;
+
+	static bool available( void ) noexcept
+	{
+		return false;
+	}
+	static status_t begin( void ) noexcept
+	{
+		return ~started;
+	}
+	static void end( void ) noexcept {}
+	static void abort_lock_busy( void ) noexcept {}
+	static bool is_retryable( status_t ) noexcept
+	{
+		return false;
+	}
+	static bool is_conflict( status_t ) noexcept
+	{
+		return false;
+	}
+	static bool is_capacity( status_t ) noexcept
+	{
+		return false;
+	}
+	static bool is_lock_busy( status_t ) noexcept
+	{
+		return false;
+	}
+#endif
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief mutex wrapper that elides the lock by hardware transactional memory (Intel RTM or ARM TME)
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<T, obj_elided_mutex<>>.
+ * lock() starts a hardware transaction instead of locking, so the critical sections that touch the disjoint parts of T run concurrently.
+ * If the transaction aborts MAX_RETRIES times, or it aborts by the reason that is not retryable, lock() locks the underlying mutex as the fallback.
+ * A transaction reads the fallback flag at the beginning, therefore it is aborted when other thread takes the fallback lock, and the mutual exclusion is kept.
+ *
+ * If the hardware transactional memory is not available at compile time (e.g. without -mrtm) or at run time, this always uses the fallback lock.
+ *
+ * unlock() ends the transaction or releases the fallback lock. Which one is decided by the fallback flag of this mutex, not by the transactional state of the thread.
+ * Therefore the move-assignment of single_accessor, that unlocks the old mutex while the new mutex is held, releases the correct one
+ * even if one of them is elided and the other holds the fallback lock.
+ *
+ * lock_get(), lock_get(prio) and try_lock_get*() of obj_mutex copy the carrier pointer before locking, and single_accessor releases it after unlocking.
+ * Therefore the reference counter of shared_storage and intrusive_storage is not written in the transaction.
+ *
+ * Guidance:
+ * @li The critical section should be short and should not do any system call, I/O or allocation, they abort the transaction.
+ * @li Do not combine with obj_instrumented_mutex. Its counters are written in the transaction, so all transactions conflict.
+ * @li Do not copy obj_mutex (shared_clone()) or move-assign single_accessor while holding the elided lock. They write the reference counter in the transaction.
+ * @li try_lock() may succeed while other thread holds the elided lock. This is the nature of the lock elision.
+ *
+ * @tparam MTX_T type of the underlying mutex that is used as the fallback
+ * @tparam MAX_RETRIES maximum number of the transactions before taking the fallback lock
+ */
+template <typename MTX_T = std::mutex, unsigned int MAX_RETRIES = 3>
+class obj_elided_mutex {
+public:
+	obj_elided_mutex( void )
+	  : fallback_locked_( false )
+	  , mtx_()
+	  , padding_ {}
+	  , aborts_( 0 )
+	  , conflict_aborts_( 0 )
+	  , capacity_aborts_( 0 )
+	  , lock_busy_aborts_( 0 )
+	  , fallbacks_( 0 )
+	  , node_ { nullptr, nullptr, this, &get_stats_of_owner }
+	{
+		obj_mutex_impl::stats_registry_list<obj_elision_stats>::add( &node_ );
+	}
+
+	~obj_elided_mutex()
+	{
+		obj_mutex_impl::stats_registry_list<obj_elision_stats>::remove( &node_ );
+	}
+
+	/**
+	 * @brief check the hardware transactional memory is available
+	 *
+	 * @return true lock() tries the transaction
+	 * @return false lock() always takes the fallback lock
+	 */
+	static bool htm_enabled( void ) noexcept
+	{
+		return obj_mutex_impl::htm::available();
+	}
+
+	void lock( void )
+	{
+		if ( htm_enabled() ) {
+			for ( unsigned int i = 0; i < MAX_RETRIES; i++ ) {
+				obj_mutex_impl::htm::status_t st = obj_mutex_impl::htm::begin();
+				if ( st == obj_mutex_impl::htm::started ) {
+					// fallback_locked_をトランザクションの読み出し集合に入れる。以後、フォールバックのロックが取得されると、このトランザクションはアボートする。
+					if ( !fallback_locked_.load( std::memory_order_relaxed ) ) {
+						return;
+					}
+					obj_mutex_impl::htm::abort_lock_busy();
+				}
+
+				// ここはトランザクションの外であるため、統計の更新は他のトランザクションにのみ影響する。
+				if ( !record_abort( st ) ) {
+					break;
+				}
+			}
+		}
+
+		mtx_.lock();
+		fallback_locked_.store( true, std::memory_order_relaxed );
+		fallbacks_.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	bool try_lock( void )
+	{
+		if ( htm_enabled() ) {
+			obj_mutex_impl::htm::status_t st = obj_mutex_impl::htm::begin();
+			if ( st == obj_mutex_impl::htm::started ) {
+				if ( !fallback_locked_.load( std::memory_order_relaxed ) ) {
+					return true;
+				}
+				obj_mutex_impl::htm::abort_lock_busy();
+			}
+			record_abort( st );
+		}
+
+		if ( !mtx_.try_lock() ) {
+			return false;
+		}
+		fallback_locked_.store( true, std::memory_order_relaxed );
+		fallbacks_.fetch_add( 1, std::memory_order_relaxed );
+		return true;
+	}
+
+	void unlock( void )
+	{
+		// 呼び出し元はこのmutexを保持している。エリジョン中であれば、fallback_locked_は必ずfalseである(trueであればアボートしている)。
+		if ( fallback_locked_.load( std::memory_order_relaxed ) ) {
+			fallback_locked_.store( false, std::memory_order_release );
+			mtx_.unlock();
+		} else {
+			obj_mutex_impl::htm::end();
+		}
+	}
+
+	/**
+	 * @brief get the snapshot of the statistics of the aborts and the fallbacks
+	 *
+	 * Each value is read individually, so the snapshot may not be consistent b/w the values while other threads are locking.
+	 */
+	obj_elision_stats stats( void ) const
+	{
+		return obj_elision_stats {
+			static_cast<const void*>( this ),
+			aborts_.load( std::memory_order_relaxed ),
+			conflict_aborts_.load( std::memory_order_relaxed ),
+			capacity_aborts_.load( std::memory_order_relaxed ),
+			lock_busy_aborts_.load( std::memory_order_relaxed ),
+			fallbacks_.load( std::memory_order_relaxed ) };
+	}
+
+private:
+	obj_elided_mutex( const obj_elided_mutex& )            = delete;
+	obj_elided_mutex& operator=( const obj_elided_mutex& ) = delete;
+
+	static obj_elision_stats get_stats_of_owner( const void* p_owner )
+	{
+		return static_cast<const obj_elided_mutex*>( p_owner )->stats();
+	}
+
+	/**
+	 * @brief record the abort, and wait for the release of the fallback lock if it is the reason
+	 *
+	 * @return true the transaction should be retried
+	 * @return false the transaction should not be retried, e.g. by the capacity overflow
+	 */
+	bool record_abort( obj_mutex_impl::htm::status_t st )
+	{
+		aborts_.fetch_add( 1, std::memory_order_relaxed );
+		if ( obj_mutex_impl::htm::is_conflict( st ) ) {
+			conflict_aborts_.fetch_add( 1, std::memory_order_relaxed );
+		}
+		if ( obj_mutex_impl::htm::is_capacity( st ) ) {
+			capacity_aborts_.fetch_add( 1, std::memory_order_relaxed );
+		}
+		if ( obj_mutex_impl::htm::is_lock_busy( st ) ) {
+			lock_busy_aborts_.fetch_add( 1, std::memory_order_relaxed );
+			// フォールバックの保持者が解放するまで待ってから再試行する。即座に再試行すると、全員がフォールバックに流れてしまう。
+			while ( fallback_locked_.load( std::memory_order_acquire ) ) {
+				obj_mutex_impl::cpu_relax();
+			}
+			return true;
+		}
+		return obj_mutex_impl::htm::is_retryable( st );
+	}
+
+	std::atomic<bool> fallback_locked_;   // トランザクションが読み出すため、統計とは別のキャッシュラインに置く。
+	MTX_T             mtx_;
+	char              padding_[OBJECT_MUTEX_CACHE_LINE_SIZE];
+
+	std::atomic<std::uint64_t> aborts_;
+	std::atomic<std::uint64_t> conflict_aborts_;
+	std::atomic<std::uint64_t> capacity_aborts_;
+	std::atomic<std::uint64_t> lock_busy_aborts_;
+	std::atomic<std::uint64_t> fallbacks_;
+
+	obj_mutex_impl::basic_stats_registry_node<obj_elision_stats> node_;   // 隣接ノードの登録・解除で書き換わるため、fallback_locked_とは別のキャッシュラインに置く。
+};
+
+#endif
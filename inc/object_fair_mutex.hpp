@@ -0,0 +1,297 @@
+/**
+ * @file object_fair_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief fair queueing mutex with priorities for obj_mutex
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_FAIR_MUTEX_HPP_
+#define OBJECT_FAIR_MUTEX_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "object_mutex.hpp"
+#include "object_spin_mutex.hpp"
+
+/**
+ * @brief priority of obj_fair_mutex::lock()
+ */
+enum class obj_lock_priority : unsigned int {
+	low    = 0,
+	normal = 1,
+	high   = 2,
+};
+
+/**
+ * @brief fair queueing mutex that satisfies the requirements of Lockable
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<T, obj_fair_mutex>.
+ * obj_mutex::lock_get(obj_lock_priority::high) locks with a priority. lock_get() and with_lock() lock with obj_lock_priority::normal.
+ *
+ * Each priority has a MCS queue lock. A waiter links its node on its stack by the atomic exchange of the tail, and spins on the flag of its own node.
+ * The first waiter of each queue (the head) competes for the lock word, and unlock() hands over the lock directly to the head of the highest priority.
+ * The head passes the head of its queue to the next node while holding the lock. There is no internal mutex, and the uncontended lock() and unlock() are one CAS each.
+ * Therefore a waiter is never overtaken by the same or lower priority, and the wait time is bounded by the waiters before it and the higher priority waiters.
+ * A waiter spins spin_count times, yields yield_count times, and then parks by obj_mutex_impl::atomic_wait() on the word of its queue in this mutex,
+ * so the node on the stack is never touched after the handoff.
+ *
+ * Guidance:
+ * @li This is suitable when the bounded wait of each waiter matters more than the throughput. The handoff is slower than std::mutex under contention,
+ *     because the lock is not stolen by a running thread while the next owner is waking up. If the threads are more than the cores,
+ *     the next owner may be preempted, and every handoff waits for it (lock convoy).
+ * @li The higher priority has precedence strictly. If the high priority waiters never run out, the lower priority waiters starve.
+ * @li The size is num_priorities + 1 cache lines, because the queue of each priority has its own cache line.
+ */
+class obj_fair_mutex {
+public:
+	static constexpr unsigned int spin_count  = 64;   //!< number of pause instructions to spin before yielding
+	static constexpr unsigned int yield_count = 16;   //!< number of std::this_thread::yield() before parking
+
+	obj_fair_mutex( void )
+	  : state_( 0 )
+	  , queues_()
+	{
+	}
+
+	void lock( void )
+	{
+		lock( obj_lock_priority::normal );
+	}
+
+	void lock( obj_lock_priority prio )
+	{
+		const unsigned int p = static_cast<unsigned int>( prio );
+
+		// 同じ優先度の待ち手がいなければ、ロック語のCASだけで獲得する。
+		if ( queues_[p].p_tail_.load( std::memory_order_relaxed ) == nullptr ) {
+			std::uint32_t expected = 0;
+			if ( state_.compare_exchange_strong( expected, locked_bit, std::memory_order_acquire, std::memory_order_relaxed ) ) {
+				return;
+			}
+		}
+		lock_slow( p );
+	}
+
+	bool try_lock( void )
+	{
+		// 先頭の待ち手がいる間はstate_が0にならないため、待ち手を追い越すことはない。
+		std::uint32_t expected = 0;
+		return state_.compare_exchange_strong( expected, locked_bit, std::memory_order_acquire, std::memory_order_relaxed );
+	}
+
+	void unlock( void )
+	{
+		std::uint32_t s = state_.load( std::memory_order_relaxed );
+		while ( true ) {
+			if ( s == locked_bit ) {
+				if ( state_.compare_exchange_weak( s, 0, std::memory_order_release, std::memory_order_relaxed ) ) {
+					return;
+				}
+				continue;
+			}
+
+			// locked_bitは立てたまま、最も高い優先度の先頭の待ち手にロックを引き渡す。
+			unsigned int p = num_priorities - 1;
+			while ( ( s & head_bit( p ) ) == 0 ) {
+				p--;
+			}
+			if ( state_.compare_exchange_weak( s, s & ~head_bit( p ), std::memory_order_acquire, std::memory_order_relaxed ) ) {
+				queues_[p].granted_.store( 1, std::memory_order_seq_cst );
+				wake( queues_[p] );
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief get the number of waiters
+	 *
+	 * This is for diagnostics. The answer may be stale when this returns.
+	 * A waiter is counted after its place in the queue is fixed.
+	 */
+	std::size_t num_waiters( void ) const
+	{
+		std::size_t ans = 0;
+		for ( const auto& q : queues_ ) {
+			ans += q.num_waiters_.load( std::memory_order_relaxed );
+		}
+		return ans;
+	}
+
+private:
+	obj_fair_mutex( const obj_fair_mutex& )            = delete;
+	obj_fair_mutex& operator=( const obj_fair_mutex& ) = delete;
+
+	static constexpr unsigned int  num_priorities = 3;
+	static constexpr std::uint32_t locked_bit     = 1;
+
+	static constexpr std::uint32_t head_bit( unsigned int p )
+	{
+		return 2U << p;   // 優先度pの先頭の待ち手がロックを待っている
+	}
+
+	/**
+	 * @brief node of the MCS queue. This is placed on the stack of lock().
+	 */
+	struct waiter_node {
+		waiter_node( void )
+		  : p_next_( nullptr )
+		  , is_head_( 0 )
+		{
+		}
+
+		std::atomic<waiter_node*>  p_next_;
+		std::atomic<std::uint32_t> is_head_;   // 所有者のスレッドがスピンするフラグ
+	};
+
+	/**
+	 * @brief MCS queue of one priority
+	 */
+	struct alignas( OBJECT_MUTEX_CACHE_LINE_SIZE ) waiter_queue {
+		waiter_queue( void )
+		  : p_tail_( nullptr )
+		  , granted_( 0 )
+		  , parked_( 0 )
+		  , wake_seq_( 0 )
+		  , num_waiters_( 0 )
+		{
+		}
+
+		std::atomic<waiter_node*>  p_tail_;
+		std::atomic<std::uint32_t> granted_;    // unlock()が先頭の待ち手にロックを引き渡したことを示す
+		std::atomic<std::uint32_t> parked_;     // atomic_wait()で眠っている待ち手の数
+		std::atomic<std::uint32_t> wake_seq_;   // 眠っている待ち手を起こすときに更新する語
+		std::atomic<std::size_t>   num_waiters_;
+	};
+
+	void lock_slow( unsigned int p )
+	{
+		waiter_queue& q = queues_[p];
+		waiter_node   w;
+		bool          is_counted = false;
+
+		waiter_node* p_prev = q.p_tail_.exchange( &w, std::memory_order_acq_rel );
+		if ( p_prev != nullptr ) {
+			p_prev->p_next_.store( &w, std::memory_order_release );
+			q.num_waiters_.fetch_add( 1, std::memory_order_relaxed );
+			is_counted = true;
+			wait_until( q, [&w]() { return w.is_head_.load( std::memory_order_seq_cst ) != 0; } );
+		}
+
+		// キューの先頭になった。前の先頭から引き継いだ場合は、前の先頭がロックを保持したまま先頭の待ち手のビットを立て済みである。
+		// そうでなければ、ロック語を獲得するか、先頭の待ち手として登録する。
+		// 先頭の待ち手のビットはlocked_bitが立っている間だけ存在するため、s == 0はロックが空いていて待ち手もいないことを示す。
+		bool          is_acquired = false;
+		std::uint32_t s           = state_.load( std::memory_order_relaxed );
+		while ( p_prev == nullptr ) {
+			if ( s == 0 ) {
+				if ( state_.compare_exchange_weak( s, locked_bit, std::memory_order_acquire, std::memory_order_relaxed ) ) {
+					is_acquired = true;
+					break;
+				}
+			} else {
+				if ( state_.compare_exchange_weak( s, s | head_bit( p ), std::memory_order_relaxed, std::memory_order_relaxed ) ) {
+					break;
+				}
+			}
+		}
+		if ( !is_acquired ) {
+			if ( !is_counted ) {
+				q.num_waiters_.fetch_add( 1, std::memory_order_relaxed );
+				is_counted = true;
+			}
+			wait_until( q, [&q]() { return q.granted_.load( std::memory_order_seq_cst ) != 0; } );
+			q.granted_.store( 0, std::memory_order_relaxed );   // 同じ優先度の次の先頭は、下のpass_head()より後にしか現れない。
+		}
+		if ( is_counted ) {
+			q.num_waiters_.fetch_sub( 1, std::memory_order_relaxed );
+		}
+
+		pass_head( q, &w );
+	}
+
+	/**
+	 * @brief make the next node the head of the queue, or empty the queue
+	 *
+	 * This is called while holding the lock. The head bit of the next node is set here,
+	 * so that unlock() does not hand over the lock to a lower priority before the next node runs.
+	 */
+	void pass_head( waiter_queue& q, waiter_node* p_w )
+	{
+		waiter_node* p_next = p_w->p_next_.load( std::memory_order_acquire );
+		if ( p_next == nullptr ) {
+			waiter_node* p_expected = p_w;
+			if ( q.p_tail_.compare_exchange_strong( p_expected, nullptr, std::memory_order_release, std::memory_order_relaxed ) ) {
+				return;
+			}
+			// 次の待ち手がtailを交換した後、p_next_を書き込むまで待つ。
+			while ( ( p_next = p_w->p_next_.load( std::memory_order_acquire ) ) == nullptr ) {
+				obj_mutex_impl::cpu_relax();
+			}
+		}
+		state_.fetch_or( head_bit( p_index( q ) ), std::memory_order_acq_rel );
+		p_next->is_head_.store( 1, std::memory_order_seq_cst );
+		wake( q );   // p_nextのノードは、この後すぐに破棄されうるため、ノードではなくキューの語で起こす。
+	}
+
+	unsigned int p_index( const waiter_queue& q ) const
+	{
+		return static_cast<unsigned int>( &q - queues_ );
+	}
+
+	/**
+	 * @brief spin and park until pred returns true
+	 */
+	template <typename PRED>
+	static void wait_until( waiter_queue& q, PRED pred )
+	{
+		for ( unsigned int i = 0; i < spin_count; i++ ) {
+			if ( pred() ) {
+				return;
+			}
+			obj_mutex_impl::cpu_relax();
+		}
+		// 引き渡し元や前の待ち手が同じコアで実行待ちの場合があるため、眠る前にCPUを譲る。
+		for ( unsigned int i = 0; i < yield_count; i++ ) {
+			if ( pred() ) {
+				return;
+			}
+			std::this_thread::yield();
+		}
+
+		while ( !pred() ) {
+			// 条件の読み出しと、wake()の条件の書き込みとparked_の読み出しは、すべてseq_cstである。
+			// そのため、待ち手が条件の成立を見落とすならば、wake()は必ずparked_の増加を見て起こす。
+			q.parked_.fetch_add( 1, std::memory_order_seq_cst );
+			std::uint32_t seq = q.wake_seq_.load( std::memory_order_acquire );
+			if ( !pred() ) {
+				obj_mutex_impl::atomic_wait( q.wake_seq_, seq );
+			}
+			q.parked_.fetch_sub( 1, std::memory_order_relaxed );
+		}
+	}
+
+	/**
+	 * @brief wake up the parked waiters of q after the flag of the condition is set by a seq_cst store
+	 */
+	static void wake( waiter_queue& q )
+	{
+		if ( q.parked_.load( std::memory_order_seq_cst ) != 0 ) {
+			// 同じキューの他の待ち手も起きるが、条件を再確認して再び眠る。
+			q.wake_seq_.fetch_add( 1, std::memory_order_release );
+			obj_mutex_impl::atomic_notify_all( q.wake_seq_ );
+		}
+	}
+
+	std::atomic<std::uint32_t> state_;   // locked_bitと、優先度ごとの先頭の待ち手のビット
+	waiter_queue               queues_[num_priorities];
+};
+
+#endif
@@ -0,0 +1,359 @@
+/**
+ * @file object_instrumented_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief mutex wrapper that records the contention statistics for obj_mutex
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_INSTRUMENTED_MUTEX_HPP_
+#define OBJECT_INSTRUMENTED_MUTEX_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+#include "object_mutex.hpp"
+
+/**
+ * @brief snapshot of the statistics of obj_instrumented_mutex
+ */
+struct obj_mutex_stats {
+	const void*              id;             //!< identifier of the mutex. this is same while the mutex is alive.
+	std::uint64_t            acquisitions;   //!< number of acquisitions of the exclusive lock and the shared lock
+	std::uint64_t            contended;      //!< number of acquisitions that the first try_lock failed
+	std::chrono::nanoseconds total_wait;     //!< total time to wait for the lock in the contended acquisitions
+	std::chrono::nanoseconds max_hold;       //!< maximum time to hold the exclusive lock
+};
+
+struct obj_elision_stats;
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief node of the list of obj_mutex_stats_registry
+ *
+ * @tparam STATS_T type of the statistics, obj_mutex_stats or obj_elision_stats
+ */
+template <typename STATS_T>
+struct basic_stats_registry_node {
+	basic_stats_registry_node* p_prev_;
+	basic_stats_registry_node* p_next_;
+	const void*                p_owner_;
+	STATS_T ( *p_get_stats_ )( const void* );
+};
+
+using stats_registry_node = basic_stats_registry_node<obj_mutex_stats>;
+
+/**
+ * @brief global list of the alive mutexes that provide STATS_T
+ *
+ * A mutex registers its node by its constructor, and unregisters it by its destructor.
+ * The list of each STATS_T has its own mutex.
+ *
+ * @tparam STATS_T type of the statistics, obj_mutex_stats or obj_elision_stats
+ */
+template <typename STATS_T>
+struct stats_registry_list {
+	using node_t     = basic_stats_registry_node<STATS_T>;
+	using callback_t = void ( * )( const STATS_T& );
+
+	static void set_retire_callback( callback_t p_callback )
+	{
+		std::lock_guard<std::mutex> lk( get_mtx() );
+		get_retire_callback() = p_callback;
+	}
+
+	template <typename F>
+	static void for_each( F& f )
+	{
+		std::lock_guard<std::mutex> lk( get_mtx() );
+		for ( const node_t* p = get_head().p_next_; p != &get_head(); p = p->p_next_ ) {
+			f( p->p_get_stats_( p->p_owner_ ) );
+		}
+	}
+
+	static void add( node_t* p_node )
+	{
+		std::lock_guard<std::mutex> lk( get_mtx() );
+		node_t& head          = get_head();
+		p_node->p_prev_       = head.p_prev_;
+		p_node->p_next_       = &head;
+		head.p_prev_->p_next_ = p_node;
+		head.p_prev_          = p_node;
+	}
+
+	static void remove( node_t* p_node )
+	{
+		// 破棄中のmutexは他から参照されないため、統計はregistryのlockの外で取得できる。
+		const STATS_T final_stats = p_node->p_get_stats_( p_node->p_owner_ );
+
+		callback_t p_callback;
+		{
+			std::lock_guard<std::mutex> lk( get_mtx() );
+			p_node->p_prev_->p_next_ = p_node->p_next_;
+			p_node->p_next_->p_prev_ = p_node->p_prev_;
+			p_callback               = get_retire_callback();
+		}
+
+		// callbackがmutexを生成・破棄してもデッドロックしないように、lockの外で呼び出す。
+		if ( p_callback != nullptr ) {
+			p_callback( final_stats );
+		}
+	}
+
+private:
+	static std::mutex& get_mtx( void )
+	{
+		static std::mutex mtx;
+		return mtx;
+	}
+
+	static node_t& get_head( void )
+	{
+		static node_t head { &head, &head, nullptr, nullptr };
+		return head;
+	}
+
+	static callback_t& get_retire_callback( void )
+	{
+		static callback_t p_callback = nullptr;
+		return p_callback;
+	}
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief global registry of all alive obj_instrumented_mutex and obj_elided_mutex
+ *
+ * obj_instrumented_mutex and obj_elided_mutex are registered by their constructors and are unregistered by their destructors.
+ * for_each() and set_retire_callback() handle obj_instrumented_mutex.
+ * for_each_elision() and set_elision_retire_callback() handle obj_elided_mutex (object_elided_mutex.hpp).
+ */
+class obj_mutex_stats_registry {
+public:
+	using callback_t         = void ( * )( const obj_mutex_stats& );
+	using elision_callback_t = void ( * )( const obj_elision_stats& );
+
+	/**
+	 * @brief set a callback that is called with the final statistics when obj_instrumented_mutex is destructed
+	 *
+	 * The callback is called by the destructing thread after the mutex is unregistered, and the registry is not locked while calling it.
+	 * Therefore the callback is able to construct or destruct obj_instrumented_mutex.
+	 * The callback may be called concurrently by some threads, and a destruction that has started before set_retire_callback() may call the old callback.
+	 *
+	 * Note: the registration and the unregistration lock one global mutex of the registry.
+	 * Therefore the construction and the destruction of obj_instrumented_mutex, i.e. of the carrier, are serialized b/w all threads.
+	 * lock() and unlock() do not touch the registry. If obj_mutex is created and destroyed frequently on a hot path, keep the instrumented one out of it.
+	 *
+	 * @param p_callback callback function. nullptr means no callback.
+	 */
+	static void set_retire_callback( callback_t p_callback )
+	{
+		obj_mutex_impl::stats_registry_list<obj_mutex_stats>::set_retire_callback( p_callback );
+	}
+
+	/**
+	 * @brief call f for the statistics of each alive obj_instrumented_mutex
+	 *
+	 * The registry is locked while calling f. Therefore f should not construct or destruct obj_instrumented_mutex.
+	 *
+	 * @tparam F type of callable object that is callable as f(const obj_mutex_stats&)
+	 * @param f callable object
+	 */
+	template <typename F>
+	static void for_each( F&& f )
+	{
+		obj_mutex_impl::stats_registry_list<obj_mutex_stats>::for_each( f );
+	}
+
+	/**
+	 * @brief set a callback that is called with the final statistics when obj_elided_mutex is destructed
+	 *
+	 * The conditions are same to set_retire_callback(). The registration of obj_elided_mutex uses the other global mutex than obj_instrumented_mutex.
+	 *
+	 * @param p_callback callback function. nullptr means no callback.
+	 */
+	static void set_elision_retire_callback( elision_callback_t p_callback )
+	{
+		obj_mutex_impl::stats_registry_list<obj_elision_stats>::set_retire_callback( p_callback );
+	}
+
+	/**
+	 * @brief call f for the abort statistics of each alive obj_elided_mutex
+	 *
+	 * The registry is locked while calling f. Therefore f should not construct or destruct obj_elided_mutex.
+	 *
+	 * @tparam F type of callable object that is callable as f(const obj_elision_stats&)
+	 * @param f callable object
+	 */
+	template <typename F>
+	static void for_each_elision( F&& f )
+	{
+		obj_mutex_impl::stats_registry_list<obj_elision_stats>::for_each( f );
+	}
+};
+
+/**
+ * @brief mutex wrapper that records the contention statistics
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<T, obj_instrumented_mutex<std::mutex>>.
+ * Because the mutex is placed in the carrier, the statistics are recorded per carrier, and obj_mutex::stats() provides them.
+ * Instrumentation is opt-in. obj_mutex<T> with a plain mutex does not have any cost of this.
+ *
+ * The hold time is measured from the lock to the unlock, i.e. from the creation to the destruction of single_accessor.
+ * The hold time of the shared lock is not measured, because some threads hold it at the same time.
+ *
+ * @tparam MTX_T type of the underlying mutex. If MTX_T is SharedLockable or TimedLockable, this is also.
+ */
+template <typename MTX_T = std::mutex>
+class obj_instrumented_mutex {
+public:
+	obj_instrumented_mutex( void )
+	  : mtx_()
+	  , node_ { nullptr, nullptr, this, &get_stats_of_owner }
+	  , acquisitions_( 0 )
+	  , contended_( 0 )
+	  , total_wait_ns_( 0 )
+	  , max_hold_ns_( 0 )
+	  , hold_start_()
+	{
+		obj_mutex_impl::stats_registry_list<obj_mutex_stats>::add( &node_ );
+	}
+
+	~obj_instrumented_mutex()
+	{
+		obj_mutex_impl::stats_registry_list<obj_mutex_stats>::remove( &node_ );
+	}
+
+	void lock( void )
+	{
+		if ( !mtx_.try_lock() ) {
+			clock_t::time_point t0 = clock_t::now();
+			mtx_.lock();
+			record_contended( t0 );
+		}
+		count_acquisition();
+		hold_start_ = clock_t::now();
+	}
+
+	bool try_lock( void )
+	{
+		if ( !mtx_.try_lock() ) {
+			return false;
+		}
+		count_acquisition();
+		hold_start_ = clock_t::now();
+		return true;
+	}
+
+	void unlock( void )
+	{
+		std::uint64_t hold_ns = static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( clock_t::now() - hold_start_ ).count() );
+		if ( hold_ns > max_hold_ns_.load( std::memory_order_relaxed ) ) {
+			max_hold_ns_.store( hold_ns, std::memory_order_relaxed );   // lockの保持者だけが更新するため、CASは不要。
+		}
+		mtx_.unlock();
+	}
+
+	template <typename Rep, typename Period, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	bool try_lock_for( const std::chrono::duration<Rep, Period>& timeout_duration )
+	{
+		return try_lock_until( std::chrono::steady_clock::now() + timeout_duration );
+	}
+
+	template <typename Clock, typename Duration, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	bool try_lock_until( const std::chrono::time_point<Clock, Duration>& timeout_time )
+	{
+		if ( !mtx_.try_lock() ) {
+			clock_t::time_point t0 = clock_t::now();
+			if ( !mtx_.try_lock_until( timeout_time ) ) {
+				return false;
+			}
+			record_contended( t0 );
+		}
+		count_acquisition();
+		hold_start_ = clock_t::now();
+		return true;
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	void lock_shared( void )
+	{
+		if ( !mtx_.try_lock_shared() ) {
+			clock_t::time_point t0 = clock_t::now();
+			mtx_.lock_shared();
+			record_contended( t0 );
+		}
+		count_acquisition();
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	bool try_lock_shared( void )
+	{
+		if ( !mtx_.try_lock_shared() ) {
+			return false;
+		}
+		count_acquisition();
+		return true;
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	void unlock_shared( void )
+	{
+		mtx_.unlock_shared();
+	}
+
+	/**
+	 * @brief get the snapshot of the statistics
+	 *
+	 * Each value is read individually, so the snapshot may not be consistent b/w the values while other threads are locking.
+	 */
+	obj_mutex_stats stats( void ) const
+	{
+		return obj_mutex_stats {
+			static_cast<const void*>( this ),
+			acquisitions_.load( std::memory_order_relaxed ),
+			contended_.load( std::memory_order_relaxed ),
+			std::chrono::nanoseconds( total_wait_ns_.load( std::memory_order_relaxed ) ),
+			std::chrono::nanoseconds( max_hold_ns_.load( std::memory_order_relaxed ) ) };
+	}
+
+private:
+	using clock_t = std::chrono::steady_clock;
+
+	obj_instrumented_mutex( const obj_instrumented_mutex& )            = delete;
+	obj_instrumented_mutex& operator=( const obj_instrumented_mutex& ) = delete;
+
+	static obj_mutex_stats get_stats_of_owner( const void* p_owner )
+	{
+		return static_cast<const obj_instrumented_mutex*>( p_owner )->stats();
+	}
+
+	void count_acquisition( void )
+	{
+		acquisitions_.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	void record_contended( clock_t::time_point t0 )
+	{
+		contended_.fetch_add( 1, std::memory_order_relaxed );
+		total_wait_ns_.fetch_add( static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( clock_t::now() - t0 ).count() ), std::memory_order_relaxed );
+	}
+
+	MTX_T                               mtx_;
+	obj_mutex_impl::stats_registry_node node_;
+	std::atomic<std::uint64_t>          acquisitions_;
+	std::atomic<std::uint64_t>          contended_;
+	std::atomic<std::uint64_t>          total_wait_ns_;
+	std::atomic<std::uint64_t>          max_hold_ns_;
+	clock_t::time_point                 hold_start_;   // lockの保持者だけが読み書きする。
+};
+
+#endif
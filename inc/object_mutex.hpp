@@ -12,9 +12,383 @@
 #ifndef OBJECT_MUTEX_HPP_
 #define OBJECT_MUTEX_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201402L
+#include <shared_mutex>
+#endif
+
+#ifndef OBJECT_MUTEX_CACHE_LINE_SIZE
+// std::hardware_destructive_interference_size is not used here, because the value may vary with the compiler options
+// and GCC warns the use of it in a header as an ABI issue.
+#define OBJECT_MUTEX_CACHE_LINE_SIZE 64
+#endif
+
+#ifndef OBJECT_MUTEX_TRACE
+// If this is not 0, the tracing hooks are called at acquire and acquired by every member function that makes a locked single_accessor,
+// i.e. lock_get(), try_lock_get*(), lock_get_all() and co_lock_get(), and at release in single_accessor.
+// This should be same in all translation units of a program.
+#define OBJECT_MUTEX_TRACE 0
+#endif
+
+#if OBJECT_MUTEX_TRACE != 0
+#include "object_mutex_trace.hpp"
+#ifndef OBJECT_MUTEX_TRACE_SINK
+// A user is able to define OBJECT_MUTEX_TRACE_SINK( event, p_mtx ) to export the events to perf, ETW, LTTng or a user callback.
+// The default sink records the events into the per-thread ring buffer of obj_mutex_trace.
+#define OBJECT_MUTEX_TRACE_SINK( event, p_mtx ) obj_mutex_trace::record( event, p_mtx )
+#endif
+#define OBJECT_MUTEX_TRACE_HOOK( event, p_mtx ) OBJECT_MUTEX_TRACE_SINK( event, static_cast<const void*>( p_mtx ) )
+#else
+#define OBJECT_MUTEX_TRACE_HOOK( event, p_mtx ) static_cast<void>( 0 )
+#endif
+
+/**
+ * @brief storage policy that the carrier is managed by std::shared_ptr
+ *
+ * This is the default storage policy.
+ * shared_clone(), up-cast and down-cast are available.
+ */
+struct shared_storage {};
+
+/**
+ * @brief storage policy that the carrier has an intrusive reference counter
+ *
+ * The mutex, the reference counter and T are allocated by one allocation.
+ * There is no control block of std::shared_ptr, no weak counter and no vtable.
+ * shared_clone() and up-cast are available. down-cast is available only if T is a polymorphic class.
+ */
+struct intrusive_storage {};
+
+/**
+ * @brief storage policy that the carrier is embedded in obj_mutex
+ *
+ * There is no heap allocation, and the size of obj_mutex is roughly sizeof(T) + sizeof(MTX_T).
+ * obj_mutex is not movable, and shared_clone(), up-cast and down-cast are not available.
+ */
+struct inline_storage {};
+
+#if defined( __cpp_aligned_new )
+/**
+ * @brief storage policy that the carrier is managed by std::shared_ptr and is aligned to the cache line
+ *
+ * The mutex and T are placed on the different cache lines, and the carrier does not share any cache line with other carriers.
+ * This avoids false sharing b/w neighboring obj_mutex, e.g. obj_mutex in std::vector.
+ * Instead, the memory usage increases. The size of cache line is OBJECT_MUTEX_CACHE_LINE_SIZE.
+ * Other behaviors are same to shared_storage.
+ */
+struct cacheline_aligned {};
+#endif
+
+template <typename T, typename MTX_T = std::mutex, typename STORAGE_T = shared_storage>
+class obj_mutex;
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief check MTX_T has the interfaces of SharedLockable
+ *
+ * If MTX_T has lock_shared(), try_lock_shared() and unlock_shared(), value is true.
+ *
+ * @tparam MTX_T type of mutex
+ */
+template <typename MTX_T>
+struct is_shared_lockable {
+	template <typename X>
+	static auto check( X* ) -> decltype( std::declval<X&>().lock_shared(),
+	                                     std::declval<X&>().try_lock_shared(),
+	                                     std::declval<X&>().unlock_shared(),
+	                                     std::true_type() );
+
+	template <typename X>
+	static auto check( ... ) -> std::false_type;
+
+	static constexpr bool value = decltype( check<MTX_T>( nullptr ) )::value;
+};
+
+/**
+ * @brief check MTX_T has the interfaces of TimedLockable
+ *
+ * If MTX_T has try_lock_for() and try_lock_until(), value is true.
+ *
+ * @tparam MTX_T type of mutex
+ */
+template <typename MTX_T>
+struct is_timed_lockable {
+	template <typename X>
+	static auto check( X* ) -> decltype( std::declval<X&>().try_lock_for( std::chrono::milliseconds( 0 ) ),
+	                                     std::declval<X&>().try_lock_until( std::chrono::steady_clock::now() ),
+	                                     std::true_type() );
+
+	template <typename X>
+	static auto check( ... ) -> std::false_type;
+
+	static constexpr bool value = decltype( check<MTX_T>( nullptr ) )::value;
+};
+
+/**
+ * @brief check MTX_T has the interfaces of the sequence counter, like obj_seqlock_mutex
+ *
+ * If MTX_T has read_begin() and read_retry(), value is true.
+ *
+ * @tparam MTX_T type of mutex
+ */
+template <typename MTX_T>
+struct is_seq_lockable {
+	template <typename X>
+	static auto check( X* ) -> decltype( std::declval<const X&>().read_retry( std::declval<const X&>().read_begin() ),
+	                                     std::true_type() );
+
+	template <typename X>
+	static auto check( ... ) -> std::false_type;
+
+	static constexpr bool value = decltype( check<MTX_T>( nullptr ) )::value;
+};
+
+/**
+ * @brief check MTX_T can be locked with a priority, like obj_fair_mutex
+ *
+ * If MTX_T has lock(PRIORITY_T), value is true.
+ *
+ * @tparam MTX_T type of mutex
+ * @tparam PRIORITY_T type of priority
+ */
+template <typename MTX_T, typename PRIORITY_T>
+struct is_priority_lockable {
+	template <typename X>
+	static auto check( X* ) -> decltype( std::declval<X&>().lock( std::declval<PRIORITY_T>() ),
+	                                     std::true_type() );
+
+	template <typename X>
+	static auto check( ... ) -> std::false_type;
+
+	static constexpr bool value = decltype( check<MTX_T>( nullptr ) )::value;
+};
+
+/**
+ * @brief check MTX_T has the condition variable, like obj_condition_mutex
+ *
+ * If MTX_T has notify_one() and notify_all(), value is true.
+ *
+ * @tparam MTX_T type of mutex
+ */
+template <typename MTX_T>
+struct is_condition_waitable {
+	template <typename X>
+	static auto check( X* ) -> decltype( std::declval<X&>().notify_one(),
+	                                     std::declval<X&>().notify_all(),
+	                                     std::true_type() );
+
+	template <typename X>
+	static auto check( ... ) -> std::false_type;
+
+	static constexpr bool value = decltype( check<MTX_T>( nullptr ) )::value;
+};
+
+/**
+ * @brief check MTX_T has the interfaces of the upgrade lock, like obj_upgradable_mutex
+ *
+ * If MTX_T has lock_upgrade(), unlock_upgrade(), unlock_upgrade_and_lock() and unlock_and_lock_upgrade(), value is true.
+ *
+ * @tparam MTX_T type of mutex
+ */
+template <typename MTX_T>
+struct is_upgrade_lockable {
+	template <typename X>
+	static auto check( X* ) -> decltype( std::declval<X&>().lock_upgrade(),
+	                                     std::declval<X&>().unlock_upgrade(),
+	                                     std::declval<X&>().unlock_upgrade_and_lock(),
+	                                     std::declval<X&>().unlock_and_lock_upgrade(),
+	                                     std::true_type() );
+
+	template <typename X>
+	static auto check( ... ) -> std::false_type;
+
+	static constexpr bool value = decltype( check<MTX_T>( nullptr ) )::value;
+};
+
+/**
+ * @brief get the rank of the lock order of MTX_T, like obj_ranked_mutex
+ *
+ * If MTX_T has the static member rank, is_ranked is true and value is MTX_T::rank. Otherwise is_ranked is false and value is 0.
+ * lock_get_all() and clone_into() lock the ranked mutexes in the order of the rank, so that the rank check does not report them.
+ *
+ * @tparam MTX_T type of mutex
+ */
+template <typename MTX_T, typename = void>
+struct lock_rank_of {
+	static constexpr bool         is_ranked = false;
+	static constexpr unsigned int value     = 0;
+};
+
+template <typename MTX_T>
+struct lock_rank_of<MTX_T, decltype( static_cast<void>( MTX_T::rank ) )> {
+	static constexpr bool         is_ranked = true;
+	static constexpr unsigned int value     = MTX_T::rank;
+};
+
+#if defined( __GNUC__ )
+using seqlock_uintptr_t = std::uintptr_t __attribute__( ( __may_alias__ ) );   // Tの領域をワード単位でアクセスするため。
+#else
+using seqlock_uintptr_t = std::uintptr_t;
+#endif
+
+/**
+ * @brief word type to copy T by the relaxed atomic loads and stores of seqlock_read() and seqlock_write()
+ *
+ * If T is aligned to and is a multiple of std::uintptr_t, T is copied by std::uintptr_t. Otherwise, by byte.
+ */
+template <typename T, bool BY_UINTPTR = ( alignof( T ) >= alignof( std::uintptr_t ) ) && ( sizeof( T ) % sizeof( std::uintptr_t ) == 0 )>
+struct seqlock_word {
+	using type = seqlock_uintptr_t;   // 属性が失われないように、std::conditionalのテンプレート引数には渡さない。
+
+	static constexpr std::size_t num = sizeof( T ) / sizeof( type );
+};
+
+template <typename T>
+struct seqlock_word<T, false> {
+	using type = unsigned char;
+
+	static constexpr std::size_t num = sizeof( T );
+};
+
+template <typename W>
+W seqlock_load_word( const W* p_word ) noexcept
+{
+#if defined( __GNUC__ )
+	return __atomic_load_n( p_word, __ATOMIC_RELAXED );
+#elif defined( __cpp_lib_atomic_ref )
+	return std::atomic_ref<W>( const_cast<W&>( *p_word ) ).load( std::memory_order_relaxed );
+#else
+	return *static_cast<const volatile W*>( p_word );
+#endif
+}
+
+template <typename W>
+void seqlock_store_word( W* p_word, W v ) noexcept
+{
+#if defined( __GNUC__ )
+	__atomic_store_n( p_word, v, __ATOMIC_RELAXED );
+#elif defined( __cpp_lib_atomic_ref )
+	std::atomic_ref<W>( *p_word ).store( v, std::memory_order_relaxed );
+#else
+	*static_cast<volatile W*>( p_word ) = v;
+#endif
+}
+
+/**
+ * @brief copy data by the optimistic read of seqlock
+ *
+ * data may be modified by a writer while copying. In that case, the copy is discarded and is retried.
+ * data is copied by the relaxed atomic loads of each word as the seqlock recipe of H.-J. Boehm,
+ * so the read does not race with the writer that stores by seqlock_write(). The torn copy is never observed by the caller.
+ */
+template <typename T, typename MTX_T>
+T seqlock_read( const MTX_T& mtx, const T& data )
+{
+	static_assert( std::is_trivially_copyable<T>::value, "optimistic read needs trivially copyable T" );
+
+	using word_t = typename seqlock_word<T>::type;
+
+	// Tがデフォルト構築可能でなくてもよいように、共用体の領域にコピーする。Tはトリビアルにコピー可能であるため、memcpyでオブジェクトとなる。
+	union value_buffer {
+		value_buffer( void ) {}
+
+		T value;
+	} buf;
+	word_t words[seqlock_word<T>::num];
+
+	const word_t* p_src = reinterpret_cast<const word_t*>( &data );
+	while ( true ) {
+		auto seq = mtx.read_begin();
+		for ( std::size_t i = 0; i < seqlock_word<T>::num; i++ ) {
+			words[i] = seqlock_load_word( p_src + i );
+		}
+		if ( !mtx.read_retry( seq ) ) {
+			std::memcpy( static_cast<void*>( &buf.value ), words, sizeof( T ) );
+			return buf.value;
+		}
+	}
+}
+
+/**
+ * @brief store value to data by the relaxed atomic stores of each word
+ *
+ * The caller should hold the lock of seqlock. The pair of this and seqlock_read() is free from the data race.
+ */
+template <typename T>
+void seqlock_write( T& data, const T& value )
+{
+	static_assert( std::is_trivially_copyable<T>::value, "optimistic read needs trivially copyable T" );
+
+	using word_t = typename seqlock_word<T>::type;
+
+	word_t words[seqlock_word<T>::num];
+	std::memcpy( words, static_cast<const void*>( &value ), sizeof( T ) );
+
+	word_t* p_dst = reinterpret_cast<word_t*>( &data );
+	for ( std::size_t i = 0; i < seqlock_word<T>::num; i++ ) {
+		seqlock_store_word( p_dst + i, words[i] );
+	}
+}
+
+/**
+ * @brief check X is obj_mutex or not
+ */
+template <typename X>
+struct is_obj_mutex : std::false_type {};
+
+template <typename T, typename MTX_T, typename STORAGE_T>
+struct is_obj_mutex<obj_mutex<T, MTX_T, STORAGE_T>> : std::true_type {};
+
+/**
+ * @brief check T is std::atomic of a non-class type that is lock-free
+ *
+ * If value is true, obj_mutex<T>::load() and obj_mutex<T>::fetch_update() are available, and value_type is the type of the value.
+ */
+template <typename T>
+struct is_lock_free_atomic : std::false_type {};
+
+template <typename X>
+struct is_lock_free_atomic<std::atomic<X>> {
+	using value_type = X;
+#if defined( __cpp_lib_atomic_is_always_lock_free )
+	static constexpr bool value = !std::is_class<X>::value && std::atomic<X>::is_always_lock_free;
+#else
+	static constexpr bool value = std::is_integral<X>::value || std::is_pointer<X>::value;
+#endif
+};
+
+/**
+ * @brief CAS loop of obj_mutex::fetch_update()
+ */
+template <typename X, typename F>
+X atomic_fetch_update( std::atomic<X>& a, F& f, std::memory_order order )
+{
+	X old_v = a.load( std::memory_order_relaxed );
+	while ( !a.compare_exchange_weak( old_v, f( old_v ), order, std::memory_order_relaxed ) ) {
+		// 失敗した場合、old_vは最新値に更新されるため、fを再度呼び出す。
+	}
+	return old_v;
+}
+
+struct lock_all_helper;
+struct accessor_projector;
+
+}   // namespace obj_mutex_impl
 
 template <typename MTX_T = std::mutex>
 struct data_carrier_base_mtx {
@@ -23,418 +397,2680 @@ struct data_carrier_base_mtx {
 	MTX_T mtx_;
 };
 
-template <typename T, typename MTX_T = std::mutex>
-struct data_carrier_non_class : public data_carrier_base_mtx<MTX_T> {
+/**
+ * @brief base of carrier for intrusive_storage
+ *
+ * Instead of vtable, p_destroy_ has the function to delete the actual carrier.
+ */
+template <typename MTX_T = std::mutex>
+struct intrusive_data_carrier_base_mtx {
+	intrusive_data_carrier_base_mtx( void )
+	  : mtx_()
+	  , refc_( 1 )
+	  , p_destroy_( nullptr )
+	{
+	}
+
+	MTX_T                    mtx_;
+	std::atomic<std::size_t> refc_;
+	void ( *p_destroy_ )( intrusive_data_carrier_base_mtx* );
+};
+
+#if defined( __cpp_aligned_new )
+namespace obj_mutex_impl {
+
+/**
+ * @brief size of the part that is used by vptr and mtx_ in the last cache line of cacheline_data_carrier_base_mtx
+ */
+template <typename MTX_T>
+struct cacheline_tail_size {
+	static constexpr std::size_t mtx_offset = ( sizeof( void* ) + alignof( MTX_T ) - 1 ) / alignof( MTX_T ) * alignof( MTX_T );
+	static constexpr std::size_t value      = ( mtx_offset + sizeof( MTX_T ) ) % OBJECT_MUTEX_CACHE_LINE_SIZE;
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief base of carrier for cacheline_aligned
+ *
+ * padding_ fills the rest of the last cache line. Therefore T that follows this base starts from the next cache line.
+ * If only alignas is used, T may be placed in the tail padding of this base.
+ */
+template <typename MTX_T = std::mutex, std::size_t TAIL_SIZE = obj_mutex_impl::cacheline_tail_size<MTX_T>::value>
+struct alignas( OBJECT_MUTEX_CACHE_LINE_SIZE ) cacheline_data_carrier_base_mtx {
+	virtual ~cacheline_data_carrier_base_mtx() {}
+
+	MTX_T mtx_;
+	char  padding_[OBJECT_MUTEX_CACHE_LINE_SIZE - TAIL_SIZE];
+};
+
+template <typename MTX_T>
+struct alignas( OBJECT_MUTEX_CACHE_LINE_SIZE ) cacheline_data_carrier_base_mtx<MTX_T, 0> {
+	virtual ~cacheline_data_carrier_base_mtx() {}
+
+	MTX_T mtx_;
+};
+#endif
+
+/**
+ * @brief base of carrier for inline_storage
+ */
+template <typename MTX_T = std::mutex>
+struct inline_data_carrier_base_mtx {
+	MTX_T mtx_;
+};
+
+template <typename T, typename MTX_T = std::mutex, typename BASE_T = data_carrier_base_mtx<MTX_T>>
+struct data_carrier_non_class : public BASE_T {
 	template <typename... Args>
 	data_carrier_non_class( Args&&... args )
-	  : data_carrier_base_mtx<MTX_T>()
+	  : BASE_T()
 	  , data_( std::forward<Args>( args )... )
 	{
 	}
 
 	T data_;
 
-	template <typename U, typename MTX_U>
+	template <typename U, typename MTX_U, typename STORAGE_U>
 	friend class obj_mutex;
 };
 
-template <typename T, typename MTX_T = std::mutex>
-struct data_carrier_class : public data_carrier_base_mtx<MTX_T>, public T {
+template <typename T, typename MTX_T = std::mutex, typename BASE_T = data_carrier_base_mtx<MTX_T>>
+struct data_carrier_class : public BASE_T, public T {
 	template <typename... Args>
 	data_carrier_class( Args&&... args )
-	  : data_carrier_base_mtx<MTX_T>()
+	  : BASE_T()
 	  , T( std::forward<Args>( args )... )
 	{
 	}
 
-	template <typename U, typename MTX_U>
+	template <typename U, typename MTX_U, typename STORAGE_U>
 	friend class obj_mutex;
 };
 
-template <typename T, typename MTX_T = std::mutex>
-class obj_mutex {
+namespace obj_mutex_impl {
+
+/**
+ * @brief get a pointer to the data that is carried by a carrier
+ *
+ * This is called only at the construction of a carrier, and the result is cached in obj_mutex.
+ * Therefore lock_get() does not need RTTI to resolve the reference of T.
+ */
+template <typename T, typename MTX_T, typename BASE_T>
+T* get_data_ptr( data_carrier_non_class<T, MTX_T, BASE_T>* p_carrier )
+{
+	return &( p_carrier->data_ );
+}
+
+template <typename T, typename MTX_T, typename BASE_T>
+T* get_data_ptr( data_carrier_class<T, MTX_T, BASE_T>* p_carrier )
+{
+	return p_carrier;
+}
+
+template <typename MTX_T>
+void intrusive_add_ref( intrusive_data_carrier_base_mtx<MTX_T>* p_carrier )
+{
+	p_carrier->refc_.fetch_add( 1, std::memory_order_relaxed );
+}
+
+template <typename MTX_T>
+void intrusive_release( intrusive_data_carrier_base_mtx<MTX_T>* p_carrier )
+{
+	if ( p_carrier->refc_.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+		p_carrier->p_destroy_( p_carrier );
+	}
+}
+
+/**
+ * @brief smart pointer of the carrier for intrusive_storage
+ *
+ * @tparam CARRIER_T intrusive_data_carrier_base_mtx or the derived carrier
+ */
+template <typename CARRIER_T>
+class intrusive_carrier_ptr {
 public:
-	class single_accessor {
-	public:
-		/**
-		 * @brief get a reference of a target object
-		 *
-		 * This member function is defined in case that T(=U) is base class of ACTUAL_T or same to ACTUAL_T.
-		 *
-		 * @return T&
-		 */
-		T& ref( void )
-		{
-			if ( sp_data_ == nullptr ) {
-				throw std::logic_error( "single_accessor is empty. has been moved ?" );
-			}
-			return ref_to_data_;
-		}
-
-		/**
-		 * @brief move constructor of a new single accessor object
-		 *
-		 * @param orig
-		 */
-		single_accessor( single_accessor&& orig )
-		  : sp_data_( std::move( orig.sp_data_ ) )
-		  , lk_( std::move( orig.lk_ ) )
-		  , ref_to_data_( orig.ref_to_data_ )
-		{
-		}
+	constexpr intrusive_carrier_ptr( void ) noexcept
+	  : p_( nullptr )
+	{
+	}
 
-		/**
-		 * @brief move assignmment
-		 *
-		 * @param orig
-		 * @return single_accessor&
-		 */
-		single_accessor& operator=( single_accessor&& orig )
-		{
-			lk_.unlock();                           // 「unlock -> メモリ参照先の開放」という順番となるようにする。
-			lk_          = std::move( orig.lk_ );   // orig.lk_は、すでにlock済み
-			sp_data_     = std::move( orig.sp_data_ );
-			ref_to_data_ = orig.ref_to_data_;
-			return *this;
-		}
-
-		/**
-		 * @brief check the validity
-		 *
-		 * @return true this has a valid object
-		 * @return false this does not have any valid object. e.g. this will happen after move
-		 */
-		bool valid( void ) const
-		{
-			return ( sp_data_ != nullptr );
-		}
+	constexpr intrusive_carrier_ptr( std::nullptr_t ) noexcept
+	  : p_( nullptr )
+	{
+	}
 
-		~single_accessor()
-		{
-			// メンバ変数定義と逆順にデストラクタが起動されるため、
-			// 自動的に、unlock -> メモリ参照先の開放 という不正アクセスとはならない処理順になる。
-		}
+	/**
+	 * @brief Construct a new intrusive carrier ptr object
+	 *
+	 * @param p_arg pointer to a carrier. The reference of p_arg is moved to this object.
+	 */
+	explicit intrusive_carrier_ptr( CARRIER_T* p_arg ) noexcept
+	  : p_( p_arg )
+	{
+	}
 
-	private:
-		single_accessor( std::unique_lock<MTX_T> lk_arg, std::shared_ptr<data_carrier_base_mtx<MTX_T>> sp_data_arg, T& ref_to_data_arg )
-		  : sp_data_( std::move( sp_data_arg ) )
-		  , lk_( std::move( lk_arg ) )
-		  , ref_to_data_( ref_to_data_arg )
-		{
-		}
+	intrusive_carrier_ptr( const intrusive_carrier_ptr& orig ) noexcept
+	  : p_( orig.p_ )
+	{
+		if ( p_ != nullptr ) intrusive_add_ref( p_ );
+	}
 
-		single_accessor( const single_accessor& )            = delete;
-		single_accessor& operator=( const single_accessor& ) = delete;
+	intrusive_carrier_ptr( intrusive_carrier_ptr&& orig ) noexcept
+	  : p_( orig.p_ )
+	{
+		orig.p_ = nullptr;
+	}
 
-		std::shared_ptr<data_carrier_base_mtx<MTX_T>> sp_data_;
-		std::unique_lock<MTX_T>                       lk_;
-		T&                                            ref_to_data_;
+	template <typename Y, typename std::enable_if<std::is_convertible<Y*, CARRIER_T*>::value>::type* = nullptr>
+	intrusive_carrier_ptr( const intrusive_carrier_ptr<Y>& orig ) noexcept
+	  : p_( orig.p_ )
+	{
+		if ( p_ != nullptr ) intrusive_add_ref( p_ );
+	}
 
-		template <typename U, typename MTX_U>
-		friend class obj_mutex;
-	};
+	template <typename Y, typename std::enable_if<std::is_convertible<Y*, CARRIER_T*>::value>::type* = nullptr>
+	intrusive_carrier_ptr( intrusive_carrier_ptr<Y>&& orig ) noexcept
+	  : p_( orig.p_ )
+	{
+		orig.p_ = nullptr;
+	}
+
+	~intrusive_carrier_ptr()
+	{
+		if ( p_ != nullptr ) intrusive_release( p_ );
+	}
+
+	intrusive_carrier_ptr& operator=( const intrusive_carrier_ptr& orig ) noexcept
+	{
+		intrusive_carrier_ptr( orig ).swap( *this );
+		return *this;
+	}
+
+	intrusive_carrier_ptr& operator=( intrusive_carrier_ptr&& orig ) noexcept
+	{
+		intrusive_carrier_ptr( std::move( orig ) ).swap( *this );
+		return *this;
+	}
+
+	void swap( intrusive_carrier_ptr& other ) noexcept
+	{
+		CARRIER_T* p_tmp = p_;
+		p_               = other.p_;
+		other.p_         = p_tmp;
+	}
+
+	CARRIER_T* get( void ) const noexcept
+	{
+		return p_;
+	}
+
+	CARRIER_T* operator->( void ) const noexcept
+	{
+		return p_;
+	}
+
+	CARRIER_T& operator*( void ) const noexcept
+	{
+		return *p_;
+	}
+
+	friend bool operator==( const intrusive_carrier_ptr& a, std::nullptr_t ) noexcept
+	{
+		return a.p_ == nullptr;
+	}
+
+	friend bool operator!=( const intrusive_carrier_ptr& a, std::nullptr_t ) noexcept
+	{
+		return a.p_ != nullptr;
+	}
+
+private:
+	CARRIER_T* p_;
+
+	template <typename Y>
+	friend class intrusive_carrier_ptr;
+};
+
+/**
+ * @brief traits of storage policy
+ *
+ * carrier_base_t: base type of carriers. mtx_ is accessible via carrier_base_t.
+ * carrier_ptr_t: type that is kept by obj_mutex and accessors to access the carrier.
+ * carrier_t<T>: type of the carrier that carries T.
+ * make_carrier<CARRIER_T>(args...): allocate and construct a carrier.
+ * allocate_carrier<CARRIER_T>(alloc, args...): allocate a carrier by alloc and construct it.
+ * down_cast<U>(p_carrier, p_data): down-cast with RTTI. if fail, return nullptr.
+ *
+ * @tparam STORAGE_T storage policy
+ * @tparam MTX_T type of mutex
+ */
+template <typename STORAGE_T, typename MTX_T>
+struct storage_traits;
+
+/**
+ * @brief common part of storage_traits for the storage policies that use std::shared_ptr
+ *
+ * @tparam CARRIER_BASE_T base type of carriers. This should have a virtual destructor.
+ * @tparam MTX_T type of mutex
+ */
+template <typename CARRIER_BASE_T, typename MTX_T>
+struct shared_ptr_storage_traits {
+	using carrier_base_t = CARRIER_BASE_T;
+	using carrier_ptr_t  = std::shared_ptr<carrier_base_t>;
+
+	template <typename T>
+	using carrier_t = typename std::conditional<std::is_class<T>::value,
+	                                            data_carrier_class<T, MTX_T, carrier_base_t>,
+	                                            data_carrier_non_class<T, MTX_T, carrier_base_t>>::type;
+
+	template <typename CARRIER_T, typename... Args>
+	static std::shared_ptr<CARRIER_T> make_carrier( Args&&... args )
+	{
+		return std::make_shared<CARRIER_T>( std::forward<Args>( args )... );
+	}
+
+	template <typename CARRIER_T, typename ALLOC, typename... Args>
+	static std::shared_ptr<CARRIER_T> allocate_carrier( const ALLOC& alloc, Args&&... args )
+	{
+		return std::allocate_shared<CARRIER_T>( alloc, std::forward<Args>( args )... );
+	}
+
+	template <typename U, typename T>
+	static U* down_cast( carrier_base_t* p_carrier, T* )
+	{
+		// carrierは仮想デストラクタを持つため、Tがポリモーフィックでなくても、carrierからのdynamic_castで判定できる。
+		return dynamic_cast<U*>( p_carrier );
+	}
+};
+
+template <typename MTX_T>
+struct storage_traits<shared_storage, MTX_T> : public shared_ptr_storage_traits<data_carrier_base_mtx<MTX_T>, MTX_T> {};
+
+#if defined( __cpp_aligned_new )
+template <typename MTX_T>
+struct storage_traits<cacheline_aligned, MTX_T> : public shared_ptr_storage_traits<cacheline_data_carrier_base_mtx<MTX_T>, MTX_T> {};
+#endif
+
+template <typename MTX_T>
+struct storage_traits<intrusive_storage, MTX_T> {
+	using carrier_base_t = intrusive_data_carrier_base_mtx<MTX_T>;
+	using carrier_ptr_t  = intrusive_carrier_ptr<carrier_base_t>;
+
+	template <typename T>
+	using carrier_t = typename std::conditional<std::is_class<T>::value,
+	                                            data_carrier_class<T, MTX_T, carrier_base_t>,
+	                                            data_carrier_non_class<T, MTX_T, carrier_base_t>>::type;
+
+	template <typename CARRIER_T, typename... Args>
+	static intrusive_carrier_ptr<CARRIER_T> make_carrier( Args&&... args )
+	{
+		CARRIER_T* p_ans = new CARRIER_T( std::forward<Args>( args )... );
+
+		static_cast<carrier_base_t*>( p_ans )->p_destroy_ = &destroy_carrier<CARRIER_T>;
+		return intrusive_carrier_ptr<CARRIER_T>( p_ans );
+	}
+
+	template <typename CARRIER_T, typename ALLOC, typename... Args>
+	static intrusive_carrier_ptr<CARRIER_T> allocate_carrier( const ALLOC& alloc, Args&&... args )
+	{
+		using node_t        = allocated_carrier<CARRIER_T, ALLOC>;
+		using node_alloc_t  = typename std::allocator_traits<ALLOC>::template rebind_alloc<node_t>;
+		using node_traits_t = std::allocator_traits<node_alloc_t>;
+
+		node_alloc_t node_alloc( alloc );
+		node_t*      p_ans = node_traits_t::allocate( node_alloc, 1 );
+		try {
+			::new ( static_cast<void*>( p_ans ) ) node_t( alloc, std::forward<Args>( args )... );
+		} catch ( ... ) {
+			node_traits_t::deallocate( node_alloc, p_ans, 1 );
+			throw;
+		}
+
+		static_cast<carrier_base_t*>( p_ans )->p_destroy_ = &destroy_allocated_carrier<node_t, node_alloc_t>;
+		return intrusive_carrier_ptr<CARRIER_T>( p_ans );
+	}
+
+	template <typename U, typename T>
+	static U* down_cast( carrier_base_t*, T* p_data )
+	{
+		// carrierはvtableを持たないため、down castするには、Tがポリモーフィックである必要がある。
+		return dynamic_cast<U*>( p_data );
+	}
+
+private:
+	/**
+	 * @brief carrier that keeps the allocator to deallocate itself
+	 */
+	template <typename CARRIER_T, typename ALLOC>
+	struct allocated_carrier : public CARRIER_T {
+		template <typename... Args>
+		allocated_carrier( const ALLOC& alloc_arg, Args&&... args )
+		  : CARRIER_T( std::forward<Args>( args )... )
+		  , alloc_( alloc_arg )
+		{
+		}
+
+		ALLOC alloc_;
+	};
+
+	template <typename CARRIER_T>
+	static void destroy_carrier( carrier_base_t* p_carrier )
+	{
+		delete static_cast<CARRIER_T*>( p_carrier );
+	}
+
+	template <typename NODE_T, typename NODE_ALLOC_T>
+	static void destroy_allocated_carrier( carrier_base_t* p_carrier )
+	{
+		NODE_T*      p_node = static_cast<NODE_T*>( p_carrier );
+		NODE_ALLOC_T node_alloc( p_node->alloc_ );   // carrierの破棄後もdeallocateに使えるように、allocatorをコピーしておく。
+		p_node->~NODE_T();
+		std::allocator_traits<NODE_ALLOC_T>::deallocate( node_alloc, p_node, 1 );
+	}
+};
+
+template <typename MTX_T>
+struct storage_traits<inline_storage, MTX_T> {
+	using carrier_base_t = inline_data_carrier_base_mtx<MTX_T>;
+	using carrier_ptr_t  = carrier_base_t*;   // accessorは、obj_mutexに埋め込まれたcarrierを借用するだけ。
+
+	template <typename T>
+	using carrier_t = data_carrier_non_class<T, MTX_T, carrier_base_t>;
+};
+
+/**
+ * @brief accessor that holds an exclusive lock
+ *
+ * This accessor is provided by obj_mutex::lock_get().
+ *
+ * @tparam T type of the target object
+ * @tparam MTX_T type of mutex
+ * @tparam STORAGE_T storage policy of obj_mutex
+ */
+template <typename T, typename MTX_T, typename STORAGE_T>
+class single_accessor {
+public:
+	/**
+	 * @brief get a reference of a target object
+	 *
+	 * This member function is defined in case that T(=U) is base class of ACTUAL_T or same to ACTUAL_T.
+	 *
+	 * @return T&
+	 */
+	T& ref( void )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "single_accessor is empty. has been moved ?" );
+		}
+		return *p_data_;
+	}
+
+	/**
+	 * @brief move constructor of a new single accessor object
+	 *
+	 * @param orig
+	 */
+	single_accessor( single_accessor&& orig )
+	  : sp_data_( std::move( orig.sp_data_ ) )
+	  , lk_( std::move( orig.lk_ ) )
+	  , p_data_( orig.p_data_ )
+	{
+		orig.sp_data_ = nullptr;   // inline_storageの場合、carrier_ptr_tは生ポインタのため、明示的にクリアする。
+	}
+
+	/**
+	 * @brief move assignmment
+	 *
+	 * @param orig
+	 * @return single_accessor&
+	 */
+	single_accessor& operator=( single_accessor&& orig )
+	{
+		if ( lk_.owns_lock() ) {
+			OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::release, lk_.mutex() );
+			lk_.unlock();   // 「unlock -> メモリ参照先の開放」という順番となるようにする。
+		}
+		lk_           = std::move( orig.lk_ );   // orig.lk_は、すでにlock済み
+		sp_data_      = std::move( orig.sp_data_ );
+		p_data_       = orig.p_data_;   // 参照先のオブジェクトへのコピー代入とならないように、ポインタで保持する。
+		orig.sp_data_ = nullptr;
+		return *this;
+	}
+
+	/**
+	 * @brief check the validity
+	 *
+	 * @return true this has a valid object
+	 * @return false this does not have any valid object. e.g. this will happen after move
+	 */
+	bool valid( void ) const
+	{
+		return ( sp_data_ != nullptr );
+	}
+
+	/**
+	 * @brief make an accessor of a data member by moving the lock of this accessor
+	 *
+	 * The lock and the carrier are moved into the new accessor. There is no re-lock and no copy of the carrier pointer.
+	 * This accessor becomes empty.
+	 *
+	 * if this accessor is empty, this throws std::logic_error
+	 *
+	 * @code
+	 * auto acc_member = obj.lock_get().project( &S::member );
+	 * @endcode
+	 *
+	 * @tparam M type of the data member
+	 * @tparam C class that has the data member. T is C or a derived class of C.
+	 * @param p_member pointer to the data member
+	 * @return single_accessor of the data member
+	 */
+	template <typename M, typename C,
+	          typename std::enable_if<!std::is_function<M>::value &&
+	                                  ( std::is_base_of<C, typename std::remove_cv<T>::type>::value || std::is_same<C, typename std::remove_cv<T>::type>::value )>::type* = nullptr>
+	single_accessor<typename std::remove_reference<decltype( std::declval<T&>().*std::declval<M C::*>() )>::type, MTX_T, STORAGE_T> project( M C::*p_member ) &&
+	{
+		using sub_t = typename std::remove_reference<decltype( std::declval<T&>().*std::declval<M C::*>() )>::type;
+		return single_accessor<sub_t, MTX_T, STORAGE_T>( std::move( *this ), ref().*p_member );
+	}
+
+	/**
+	 * @brief make an accessor of a sub-object that f returns by moving the lock of this accessor
+	 *
+	 * f is called under the lock, and the returned reference should refer to the object that is protected by this lock, e.g. an element of a container in T.
+	 * This accessor becomes empty.
+	 *
+	 * if this accessor is empty, this throws std::logic_error
+	 *
+	 * @tparam F type of callable object that is callable as f(T&) and returns a lvalue reference
+	 * @param f callable object
+	 * @return single_accessor of the sub-object
+	 */
+	template <typename F>
+	single_accessor<typename std::remove_reference<decltype( std::declval<F&>()( std::declval<T&>() ) )>::type, MTX_T, STORAGE_T> map( F&& f ) &&
+	{
+		using ret_t = decltype( std::declval<F&>()( std::declval<T&>() ) );
+		static_assert( std::is_lvalue_reference<ret_t>::value, "f should return a lvalue reference to a sub-object" );
+		return single_accessor<typename std::remove_reference<ret_t>::type, MTX_T, STORAGE_T>( std::move( *this ), f( ref() ) );
+	}
+
+	/**
+	 * @brief wait until pred returns true
+	 *
+	 * This is available if MTX_T has the condition variable, e.g. obj_condition_mutex.
+	 * The lock is released while waiting, and is re-acquired before pred is called and before this returns.
+	 * The waiter is woken up by obj_mutex::notify_one() or obj_mutex::notify_all().
+	 *
+	 * if this accessor is empty or does not own the lock, this throws std::logic_error
+	 *
+	 * @tparam PRED type of callable object that is callable as pred(const T&)
+	 * @param pred predicate
+	 */
+	template <typename PRED, typename MTX_U = MTX_T, typename std::enable_if<is_condition_waitable<MTX_U>::value>::type* = nullptr>
+	void wait( PRED pred )
+	{
+		check_waitable();
+		const T& data = *p_data_;
+		lk_.mutex()->wait( lk_, [&pred, &data]() { return static_cast<bool>( pred( data ) ); } );
+	}
+
+	/**
+	 * @brief wait until pred returns true or the timeout duration has elapsed
+	 *
+	 * @return the last result of pred. false means the timeout.
+	 */
+	template <typename Rep, typename Period, typename PRED, typename MTX_U = MTX_T, typename std::enable_if<is_condition_waitable<MTX_U>::value>::type* = nullptr>
+	bool wait_for( const std::chrono::duration<Rep, Period>& rel_time, PRED pred )
+	{
+		check_waitable();
+		const T& data = *p_data_;
+		return lk_.mutex()->wait_for( lk_, rel_time, [&pred, &data]() { return static_cast<bool>( pred( data ) ); } );
+	}
+
+	/**
+	 * @brief wait until pred returns true or the timeout time has been reached
+	 *
+	 * @return the last result of pred. false means the timeout.
+	 */
+	template <typename Clock, typename Duration, typename PRED, typename MTX_U = MTX_T, typename std::enable_if<is_condition_waitable<MTX_U>::value>::type* = nullptr>
+	bool wait_until( const std::chrono::time_point<Clock, Duration>& timeout_time, PRED pred )
+	{
+		check_waitable();
+		const T& data = *p_data_;
+		return lk_.mutex()->wait_until( lk_, timeout_time, [&pred, &data]() { return static_cast<bool>( pred( data ) ); } );
+	}
+
+	~single_accessor()
+	{
+		// メンバ変数定義と逆順にデストラクタが起動されるため、
+		// 自動的に、unlock -> メモリ参照先の開放 という不正アクセスとはならない処理順になる。
+#if OBJECT_MUTEX_TRACE != 0
+		if ( lk_.owns_lock() ) {
+			OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::release, lk_.mutex() );
+		}
+#endif
+	}
+
+private:
+	using carrier_ptr_t = typename storage_traits<STORAGE_T, MTX_T>::carrier_ptr_t;
+
+	single_accessor( std::unique_lock<MTX_T> lk_arg, carrier_ptr_t sp_data_arg, T& ref_to_data_arg )
+	  : sp_data_( std::move( sp_data_arg ) )
+	  , lk_( std::move( lk_arg ) )
+	  , p_data_( &ref_to_data_arg )
+	{
+	}
+
+	/**
+	 * @brief Construct an empty single accessor. This is returned when try_lock_get() fails to lock.
+	 */
+	single_accessor( void )
+	  : sp_data_( nullptr )
+	  , lk_()
+	  , p_data_( nullptr )
+	{
+	}
+
+	/**
+	 * @brief Construct a single accessor of a sub-object by moving the lock of orig
+	 *
+	 * @param orig accessor that has the lock. orig becomes empty.
+	 * @param ref_to_sub_arg reference to the sub-object that is protected by the lock of orig
+	 */
+	template <typename U>
+	single_accessor( single_accessor<U, MTX_T, STORAGE_T>&& orig, T& ref_to_sub_arg )
+	  : sp_data_( std::move( orig.sp_data_ ) )
+	  , lk_( std::move( orig.lk_ ) )
+	  , p_data_( &ref_to_sub_arg )
+	{
+		orig.sp_data_ = nullptr;
+	}
+
+	single_accessor( const single_accessor& )            = delete;
+	single_accessor& operator=( const single_accessor& ) = delete;
+
+	void check_waitable( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "single_accessor is empty. has been moved ?" );
+		}
+		if ( !lk_.owns_lock() ) {
+			// lock_get_all()で同じcarrierを共有するobj_mutexを渡した場合、2つ目以降のaccessorはlockを所有しない。
+			throw std::logic_error( "single_accessor does not own the lock. the lock is owned by other accessor of lock_get_all()" );
+		}
+	}
+
+	carrier_ptr_t           sp_data_;
+	std::unique_lock<MTX_T> lk_;
+	T*                      p_data_;
+
+	template <typename U, typename MTX_U, typename STORAGE_U>
+	friend class ::obj_mutex;
+	template <typename U, typename MTX_U, typename STORAGE_U>
+	friend class single_accessor;
+	friend struct accessor_projector;
+};
+
+#if __cplusplus >= 201402L
+/**
+ * @brief accessor that holds a shared lock
+ *
+ * This accessor is provided by lock_get_shared(), and only a const reference is available.
+ * Some read_accessors are able to exist at the same time, and single_accessor is not able to exist at that time.
+ *
+ * @tparam T type of the target object
+ * @tparam MTX_T type of mutex
+ * @tparam STORAGE_T storage policy of obj_mutex
+ */
+template <typename T, typename MTX_T, typename STORAGE_T>
+class read_accessor {
+public:
+	/**
+	 * @brief get a const reference of a target object
+	 *
+	 * @return const T&
+	 */
+	const T& ref( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "read_accessor is empty. has been moved ?" );
+		}
+		return *p_data_;
+	}
+
+	/**
+	 * @brief move constructor of a new read accessor object
+	 *
+	 * @param orig
+	 */
+	read_accessor( read_accessor&& orig )
+	  : sp_data_( std::move( orig.sp_data_ ) )
+	  , lk_( std::move( orig.lk_ ) )
+	  , p_data_( orig.p_data_ )
+	{
+		orig.sp_data_ = nullptr;   // inline_storageの場合、carrier_ptr_tは生ポインタのため、明示的にクリアする。
+	}
+
+	/**
+	 * @brief move assignmment
+	 *
+	 * @param orig
+	 * @return read_accessor&
+	 */
+	read_accessor& operator=( read_accessor&& orig )
+	{
+		if ( lk_.owns_lock() ) {
+			lk_.unlock();   // 「unlock -> メモリ参照先の開放」という順番となるようにする。
+		}
+		lk_           = std::move( orig.lk_ );   // orig.lk_は、すでにlock済み
+		sp_data_      = std::move( orig.sp_data_ );
+		p_data_       = orig.p_data_;
+		orig.sp_data_ = nullptr;
+		return *this;
+	}
+
+	/**
+	 * @brief check the validity
+	 *
+	 * @return true this has a valid object
+	 * @return false this does not have any valid object. e.g. this will happen after move
+	 */
+	bool valid( void ) const
+	{
+		return ( sp_data_ != nullptr );
+	}
+
+	~read_accessor()
+	{
+		// single_accessorと同様に、メンバ変数の逆順のデストラクタ起動により、unlock -> メモリ参照先の開放 の順となる。
+	}
+
+private:
+	using carrier_ptr_t = typename storage_traits<STORAGE_T, MTX_T>::carrier_ptr_t;
+
+	read_accessor( std::shared_lock<MTX_T> lk_arg, carrier_ptr_t sp_data_arg, const T& ref_to_data_arg )
+	  : sp_data_( std::move( sp_data_arg ) )
+	  , lk_( std::move( lk_arg ) )
+	  , p_data_( &ref_to_data_arg )
+	{
+	}
+
+	read_accessor( const read_accessor& )            = delete;
+	read_accessor& operator=( const read_accessor& ) = delete;
+
+	carrier_ptr_t           sp_data_;
+	std::shared_lock<MTX_T> lk_;
+	const T*                p_data_;
+
+	template <typename U, typename MTX_U, typename STORAGE_U>
+	friend class ::obj_mutex;
+};
+
+/**
+ * @brief accessor that holds an upgrade lock
+ *
+ * This accessor is provided by lock_get_upgradable(). Only a const reference is available until upgrade().
+ * While this holds the upgrade lock, read_accessors are able to exist at the same time, but other upgradable_accessor and single_accessor are not.
+ * upgrade() waits for the read_accessors to be released and gets the exclusive lock. No writer is able to modify the object b/w the read and the upgrade,
+ * therefore the result of the lookup before upgrade() is still valid after upgrade().
+ * downgrade() goes back to the upgrade lock, and lets the readers run again.
+ *
+ * @tparam T type of the target object
+ * @tparam MTX_T type of mutex
+ * @tparam STORAGE_T storage policy of obj_mutex
+ */
+template <typename T, typename MTX_T, typename STORAGE_T>
+class upgradable_accessor {
+public:
+	/**
+	 * @brief get a const reference of a target object
+	 *
+	 * @return const T&
+	 */
+	const T& ref( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "upgradable_accessor is empty. has been moved ?" );
+		}
+		return *p_data_;
+	}
+
+	/**
+	 * @brief get a reference of a target object to modify it
+	 *
+	 * if this accessor has not been upgraded, this throws std::logic_error
+	 *
+	 * @return T&
+	 */
+	T& mutable_ref( void )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "upgradable_accessor is empty. has been moved ?" );
+		}
+		if ( !is_upgraded_ ) {
+			throw std::logic_error( "upgradable_accessor has not been upgraded. call upgrade() before modification" );
+		}
+		return *p_data_;
+	}
+
+	/**
+	 * @brief promote the upgrade lock to the exclusive lock
+	 *
+	 * This blocks until all read_accessors are released. If this has been upgraded, this does nothing.
+	 * if this accessor is empty, this throws std::logic_error
+	 */
+	void upgrade( void )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "upgradable_accessor is empty. has been moved ?" );
+		}
+		if ( !is_upgraded_ ) {
+			p_mtx_->unlock_upgrade_and_lock();
+			is_upgraded_ = true;
+		}
+	}
+
+	/**
+	 * @brief demote the exclusive lock to the upgrade lock
+	 *
+	 * If this has not been upgraded, this does nothing.
+	 * if this accessor is empty, this throws std::logic_error
+	 */
+	void downgrade( void )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "upgradable_accessor is empty. has been moved ?" );
+		}
+		if ( is_upgraded_ ) {
+			p_mtx_->unlock_and_lock_upgrade();
+			is_upgraded_ = false;
+		}
+	}
+
+	/**
+	 * @brief check this holds the exclusive lock
+	 */
+	bool is_upgraded( void ) const
+	{
+		return is_upgraded_;
+	}
+
+	/**
+	 * @brief move constructor of a new upgradable accessor object
+	 *
+	 * @param orig
+	 */
+	upgradable_accessor( upgradable_accessor&& orig )
+	  : sp_data_( std::move( orig.sp_data_ ) )
+	  , p_mtx_( orig.p_mtx_ )
+	  , is_upgraded_( orig.is_upgraded_ )
+	  , p_data_( orig.p_data_ )
+	{
+		orig.sp_data_     = nullptr;
+		orig.p_mtx_       = nullptr;
+		orig.is_upgraded_ = false;
+	}
+
+	/**
+	 * @brief move assignmment
+	 *
+	 * @param orig
+	 * @return upgradable_accessor&
+	 */
+	upgradable_accessor& operator=( upgradable_accessor&& orig )
+	{
+		release();   // 「unlock -> メモリ参照先の開放」という順番となるようにする。
+		sp_data_          = std::move( orig.sp_data_ );
+		p_mtx_            = orig.p_mtx_;
+		is_upgraded_      = orig.is_upgraded_;
+		p_data_           = orig.p_data_;
+		orig.sp_data_     = nullptr;
+		orig.p_mtx_       = nullptr;
+		orig.is_upgraded_ = false;
+		return *this;
+	}
+
+	/**
+	 * @brief check the validity
+	 *
+	 * @return true this has a valid object
+	 * @return false this does not have any valid object. e.g. this will happen after move
+	 */
+	bool valid( void ) const
+	{
+		return ( sp_data_ != nullptr );
+	}
+
+	~upgradable_accessor()
+	{
+		// std::unique_lockに相当するものがないため、メンバ変数のデストラクタより前に明示的にunlockする。
+		release();
+	}
+
+private:
+	using carrier_ptr_t = typename storage_traits<STORAGE_T, MTX_T>::carrier_ptr_t;
+
+	/**
+	 * @brief Construct a new upgradable accessor object that adopts the upgrade lock of mtx
+	 */
+	upgradable_accessor( MTX_T& mtx_arg, carrier_ptr_t sp_data_arg, T& ref_to_data_arg )
+	  : sp_data_( std::move( sp_data_arg ) )
+	  , p_mtx_( &mtx_arg )
+	  , is_upgraded_( false )
+	  , p_data_( &ref_to_data_arg )
+	{
+	}
+
+	upgradable_accessor( const upgradable_accessor& )            = delete;
+	upgradable_accessor& operator=( const upgradable_accessor& ) = delete;
+
+	void release( void )
+	{
+		if ( p_mtx_ == nullptr ) {
+			return;
+		}
+		if ( is_upgraded_ ) {
+			p_mtx_->unlock();
+		} else {
+			p_mtx_->unlock_upgrade();
+		}
+		p_mtx_       = nullptr;
+		is_upgraded_ = false;
+	}
+
+	carrier_ptr_t sp_data_;
+	MTX_T*        p_mtx_;   // nullptr: this does not hold the lock
+	bool          is_upgraded_;
+	T*            p_data_;
+
+	template <typename U, typename MTX_U, typename STORAGE_U>
+	friend class ::obj_mutex;
+};
+#endif
+
+template <typename T>
+struct batch_op_base {
+	virtual ~batch_op_base() = default;
+	virtual void invoke( T& data ) = 0;
+};
+
+template <typename T, typename F>
+struct batch_op : public batch_op_base<T> {
+	template <typename G>
+	explicit batch_op( G&& f_arg )
+	  : f_( std::forward<G>( f_arg ) )
+	{
+	}
+
+	void invoke( T& data ) override
+	{
+		f_( data );
+	}
+
+	F f_;
+};
+
+/**
+ * @brief buffer of pending operations that are applied under one lock
+ *
+ * This is provided by obj_mutex::batch().
+ * submit() stores an operation, and flush() applies all pending operations in the submitted order under one lock.
+ * When the number of pending operations reaches max_pending, submit() flushes automatically.
+ * The destructor also flushes the pending operations. If an operation throws an exception in the destructor, the exception is discarded.
+ * To receive the exception, call flush() explicitly.
+ *
+ * The operation may have move-only captures, e.g. std::unique_ptr.
+ *
+ * @tparam T type of the target object
+ * @tparam MTX_T type of mutex
+ * @tparam STORAGE_T storage policy of obj_mutex
+ */
+template <typename T, typename MTX_T, typename STORAGE_T>
+class batch_buffer {
+public:
+	batch_buffer( batch_buffer&& orig )
+	  : sp_carrier_( std::move( orig.sp_carrier_ ) )
+	  , p_mtx_( orig.p_mtx_ )
+	  , p_data_( orig.p_data_ )
+	  , max_pending_( orig.max_pending_ )
+	  , pending_( std::move( orig.pending_ ) )
+	{
+		orig.sp_carrier_ = nullptr;
+		orig.pending_.clear();
+	}
+
+	~batch_buffer()
+	{
+		try {
+			flush();
+		} catch ( ... ) {
+			// デストラクタから例外を送出しないため、破棄する。
+		}
+	}
+
+	/**
+	 * @brief store an operation
+	 *
+	 * @tparam F type of callable object that is callable as f(T&)
+	 * @param f operation
+	 */
+	template <typename F>
+	void submit( F&& f )
+	{
+		if ( sp_carrier_ == nullptr ) {
+			throw std::logic_error( "batch_buffer is empty. has been moved ?" );
+		}
+		pending_.emplace_back( new batch_op<T, typename std::decay<F>::type>( std::forward<F>( f ) ) );
+		if ( pending_.size() >= max_pending_ ) {
+			flush();
+		}
+	}
+
+	/**
+	 * @brief apply all pending operations under one lock
+	 *
+	 * If an operation throws an exception, the operations after it are discarded, and the exception is rethrown.
+	 */
+	void flush( void )
+	{
+		if ( pending_.empty() ) {
+			return;
+		}
+
+		std::vector<std::unique_ptr<batch_op_base<T>>> ops;
+		ops.swap( pending_ );
+		pending_.reserve( max_pending_ );   // 例外発生時も、次のsubmit()で再確保しないようにする。
+
+		std::lock_guard<MTX_T> lk( *p_mtx_ );
+		for ( auto& up_op : ops ) {
+			up_op->invoke( *p_data_ );
+		}
+	}
+
+	/**
+	 * @brief get the number of pending operations
+	 */
+	std::size_t pending( void ) const
+	{
+		return pending_.size();
+	}
+
+private:
+	using carrier_ptr_t = typename storage_traits<STORAGE_T, MTX_T>::carrier_ptr_t;
+
+	batch_buffer( carrier_ptr_t sp_carrier_arg, MTX_T& mtx_arg, T& ref_to_data_arg, std::size_t max_pending_arg )
+	  : sp_carrier_( std::move( sp_carrier_arg ) )
+	  , p_mtx_( &mtx_arg )
+	  , p_data_( &ref_to_data_arg )
+	  , max_pending_( ( max_pending_arg > 0 ) ? max_pending_arg : 1 )
+	  , pending_()
+	{
+		pending_.reserve( max_pending_ );
+	}
+
+	batch_buffer( const batch_buffer& )            = delete;
+	batch_buffer& operator=( const batch_buffer& ) = delete;
+	batch_buffer& operator=( batch_buffer&& )      = delete;
+
+	carrier_ptr_t                                  sp_carrier_;   // 参照先のobj_mutexが破棄されても、carrierを保持する。
+	MTX_T*                                         p_mtx_;
+	T*                                             p_data_;
+	std::size_t                                    max_pending_;
+	std::vector<std::unique_ptr<batch_op_base<T>>> pending_;
+
+	template <typename U, typename MTX_U, typename STORAGE_U>
+	friend class ::obj_mutex;
+};
+
+/**
+ * @brief lock guard of two mutexes for clone_into()
+ *
+ * The mutexes are locked in the order of the address as same as lock_get_all(). Therefore two clone_into() in the opposite direction do not deadlock.
+ * If both mutexes have the different ranks, e.g. obj_ranked_mutex, they are locked in the order of the rank instead.
+ * If both are the same mutex, e.g. by shared_clone(), it is locked only once.
+ */
+template <typename MTX_A, typename MTX_B>
+class ordered_lock_pair {
+public:
+	ordered_lock_pair( MTX_A& mtx_a, MTX_B& mtx_b )
+	  : mtx_a_( mtx_a )
+	  , mtx_b_( mtx_b )
+	  , is_same_( static_cast<void*>( &mtx_a ) == static_cast<void*>( &mtx_b ) )
+	{
+		if ( is_same_ ) {
+			mtx_a_.lock();
+		} else if ( is_a_first( mtx_a, mtx_b ) ) {
+			std::unique_lock<MTX_A> lk_a( mtx_a_ );
+			mtx_b_.lock();
+			lk_a.release();
+		} else {
+			std::unique_lock<MTX_B> lk_b( mtx_b_ );
+			mtx_a_.lock();
+			lk_b.release();
+		}
+	}
+
+	~ordered_lock_pair()
+	{
+		if ( !is_same_ ) {
+			mtx_b_.unlock();
+		}
+		mtx_a_.unlock();
+	}
+
+private:
+	ordered_lock_pair( const ordered_lock_pair& )            = delete;
+	ordered_lock_pair& operator=( const ordered_lock_pair& ) = delete;
+
+	static bool is_a_first( MTX_A& mtx_a, MTX_B& mtx_b )
+	{
+		if ( lock_rank_of<MTX_A>::is_ranked && lock_rank_of<MTX_B>::is_ranked && ( lock_rank_of<MTX_A>::value != lock_rank_of<MTX_B>::value ) ) {
+			return lock_rank_of<MTX_A>::value < lock_rank_of<MTX_B>::value;
+		}
+		return std::less<void*>()( static_cast<void*>( &mtx_a ), static_cast<void*>( &mtx_b ) );
+	}
+
+	MTX_A& mtx_a_;
+	MTX_B& mtx_b_;
+	bool   is_same_;
+};
+
+/**
+ * @brief helper to make a single accessor of a sub-object, e.g. an element of a container in T
+ *
+ * The lock of the original accessor is moved into the new accessor. There is no re-lock.
+ */
+struct accessor_projector {
+	template <typename U, typename T, typename MTX_T, typename STORAGE_T>
+	static single_accessor<U, MTX_T, STORAGE_T> project( single_accessor<T, MTX_T, STORAGE_T>&& orig, U& ref_to_sub )
+	{
+		return single_accessor<U, MTX_T, STORAGE_T>( std::move( orig ), ref_to_sub );
+	}
+
+	template <typename U, typename MTX_T, typename STORAGE_T>
+	static single_accessor<U, MTX_T, STORAGE_T> make_empty( void )
+	{
+		return single_accessor<U, MTX_T, STORAGE_T>();
+	}
+
+	/**
+	 * @brief make single accessor with the lock that has been acquired by the caller, e.g. by an awaitable of coroutine
+	 */
+	template <typename U, typename MTX_T, typename STORAGE_T>
+	static single_accessor<U, MTX_T, STORAGE_T> adopt( std::unique_lock<MTX_T> lk, typename storage_traits<STORAGE_T, MTX_T>::carrier_ptr_t sp_carrier, U& ref_to_data )
+	{
+		return single_accessor<U, MTX_T, STORAGE_T>( std::move( lk ), std::move( sp_carrier ), ref_to_data );
+	}
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief A wrapper class that exclusively controls access to T
+ *
+ * @tparam T type of the target object
+ * @tparam MTX_T type of mutex
+ * @tparam STORAGE_T storage policy. shared_storage, intrusive_storage, inline_storage, cacheline_aligned or deferred_reclaim_storage(object_mutex_reclaim.hpp)
+ */
+template <typename T, typename MTX_T, typename STORAGE_T>
+class obj_mutex {
+public:
+	using single_accessor = obj_mutex_impl::single_accessor<T, MTX_T, STORAGE_T>;
+	using batch_buffer    = obj_mutex_impl::batch_buffer<T, MTX_T, STORAGE_T>;
+#if __cplusplus >= 201402L
+	using read_accessor       = obj_mutex_impl::read_accessor<T, MTX_T, STORAGE_T>;
+	using upgradable_accessor = obj_mutex_impl::upgradable_accessor<T, MTX_T, STORAGE_T>;
+#endif
+
+	//////////////////////
+	/**
+	 * @brief Default constructor of a new obj mutex object
+	 *
+	 * If T has a default constructor, this default constructor is defined.
+	 *
+	 * @tparam U
+	 */
+	template <typename U = T, typename std::enable_if<std::is_default_constructible<U>::value>::type* = nullptr>
+	obj_mutex( void )
+	  : obj_mutex( carrier_tag(), storage_traits_t::template make_carrier<carrier_t<U>>() )
+	{
+	}
+
+	/**
+	 * @brief Move constructor of a new obj mutex object with up-cast or no cast
+	 *
+	 * @tparam U original type of move
+	 * @tparam std::enable_if<std::is_base_of<T, U>::value>::type
+	 * @param orig
+	 */
+	template <typename U, typename std::enable_if<std::is_base_of<T, U>::value || std::is_same<T, U>::value>::type* = nullptr>
+	obj_mutex( obj_mutex<U, MTX_T, STORAGE_T>&& orig )
+	  : p_data_( orig.p_data_ )
+	  , sp_data_( std::move( orig.sp_data_ ) )
+	{
+		orig.p_data_ = nullptr;
+	}
+
+	/**
+	 * @brief Move constructor of a new obj mutex object with down cast
+	 *
+	 * @tparam U original type of move
+	 * @tparam std::enable_if<std::is_base_of<T, U>::value>::type
+	 * @param orig
+	 *
+	 * @exception std::bad_cast fail to down-cast from U to T. This means T is not derived class of U
+	 */
+	template <typename U = T, typename std::enable_if<std::is_base_of<U, T>::value && !std::is_same<T, U>::value>::type* = nullptr>
+	obj_mutex( obj_mutex<U, MTX_T, STORAGE_T>&& orig )
+	  : p_data_( storage_traits_t::template down_cast<T>( orig.sp_data_.get(), orig.p_data_ ) )   // down castのチェックは、ここで一度だけ行う。
+	  , sp_data_()
+	{
+		if ( p_data_ == nullptr ) {
+			throw std::bad_cast();   // fail to down cast or could not be convertible
+		}
+		sp_data_     = std::move( orig.sp_data_ );
+		orig.p_data_ = nullptr;
+	}
+
+	/**
+	 * @brief Construct a new obj mutex object
+	 *
+	 * Construct with using T(headarg, args...)
+	 *
+	 * @tparam HEADArg this is a type of 1st argument, and is not type of obj_mutex<U>
+	 * @tparam Args these are the types of 2nd and more arguments
+	 * @param headarg 1st argument of T's constructor
+	 * @param args 2nd and more arguments of T's constructor
+	 */
+	template <typename HEADArg, typename U = T, typename MTX_U = MTX_T, typename... Args,
+	          typename std::enable_if<
+				  !std::is_same<
+					  obj_mutex<U, MTX_U, STORAGE_T>,
+					  typename std::remove_cv<
+						  typename std::remove_reference<HEADArg>::type>::type>::value &&
+				  !std::is_same<
+					  std::allocator_arg_t,
+					  typename std::remove_cv<
+						  typename std::remove_reference<HEADArg>::type>::type>::value>::type* = nullptr>
+	obj_mutex( HEADArg&& headarg, Args&&... args )
+	  : obj_mutex( carrier_tag(), storage_traits_t::template make_carrier<carrier_t<U>>( std::forward<HEADArg>( headarg ), std::forward<Args>( args )... ) )
+	{
+	}
+
+	/**
+	 * @brief Construct a new obj mutex object with an allocator
+	 *
+	 * The carrier is allocated by alloc, and constructed with using T(args...)
+	 * If std::pmr::polymorphic_allocator is passed as alloc, the carrier is placed in its memory resource.
+	 * The memory resource should outlive this object, all shared_clone() of this object and all accessors.
+	 *
+	 * @tparam ALLOC type of allocator. This is rebound to the carrier type.
+	 * @tparam Args types of arguments of T's constructor
+	 * @param alloc allocator
+	 * @param args arguments of T's constructor
+	 */
+	template <typename ALLOC, typename U = T, typename... Args>
+	obj_mutex( std::allocator_arg_t, const ALLOC& alloc, Args&&... args )
+	  : obj_mutex( carrier_tag(), storage_traits_t::template allocate_carrier<carrier_t<U>>( alloc, std::forward<Args>( args )... ) )
+	{
+	}
+
+	/**
+	 * @brief move assignmment with up-cast or no cast
+	 *
+	 * @param orig
+	 * @return obj_mutex&
+	 */
+	template <typename U, typename std::enable_if<std::is_base_of<T, U>::value || std::is_same<T, U>::value>::type* = nullptr>
+	obj_mutex& operator=( obj_mutex<U, MTX_T, STORAGE_T>&& orig )
+	{
+		p_data_      = orig.p_data_;
+		sp_data_     = std::move( orig.sp_data_ );
+		orig.p_data_ = nullptr;
+		return *this;
+	}
+
+	/**
+	 * @brief move assignmment
+	 *
+	 * @param orig
+	 * @return obj_mutex&
+	 *
+	 * @exception std::bad_cast fail to down-cast from U to T. This means T is not derived class of U
+	 */
+	template <typename U, typename std::enable_if<std::is_base_of<U, T>::value && !std::is_same<T, U>::value>::type* = nullptr>
+	obj_mutex& operator=( obj_mutex<U, MTX_T, STORAGE_T>&& orig )
+	{
+		T* p_T_tmp = storage_traits_t::template down_cast<T>( orig.sp_data_.get(), orig.p_data_ );
+		if ( p_T_tmp == nullptr ) {
+			throw std::bad_cast();   // fail to down cast or could not be convertible
+		}
+		p_data_      = p_T_tmp;
+		sp_data_     = std::move( orig.sp_data_ );
+		orig.p_data_ = nullptr;
+		return *this;
+	}
+
+	/**
+	 * @brief check the validity
+	 *
+	 * @return true this has a valid object
+	 * @return false this does not have any valid object. e.g. this will happen after move
+	 */
+	bool valid( void ) const
+	{
+		return ( sp_data_ != nullptr );
+	}
+
+	/**
+	 * @brief get single accessor object with up-cast
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U this U is base type of T
+	 * @return obj_mutex<U, MTX_T, STORAGE_T>::single_accessor
+	 */
+	template <typename U = T>
+	typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor lock_get( void )
+	{
+		// 型Tの基底クラスUへのアップキャストされたsingle_accessorを得る
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		// carrierの参照カウンタはlockの外で更新する。obj_elided_mutexのトランザクションが参照カウンタで衝突しないようにするため。
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_ );
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		return typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+	template <typename U = T>
+	typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor lock_get( void ) const
+	{
+		// 型Tの基底クラスUへのアップキャストされたsingle_accessorを得る
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_ );
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		return typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+
+	/**
+	 * @brief get single accessor object with up-cast by locking with a priority
+	 *
+	 * This is available if MTX_T can be locked with a priority, e.g. obj_fair_mutex and obj_lock_priority.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U this U is base type of T
+	 * @param prio priority that is passed to MTX_T::lock()
+	 * @return obj_mutex<U, MTX_T, STORAGE_T>::single_accessor
+	 */
+	template <typename U = T, typename PRIORITY_T, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_priority_lockable<MTX_U, PRIORITY_T>::value>::type* = nullptr>
+	typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor lock_get( PRIORITY_T prio )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		sp_carrier->mtx_.lock( prio );
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_, std::adopt_lock );
+		return typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+	template <typename U = T, typename PRIORITY_T, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_priority_lockable<MTX_U, PRIORITY_T>::value>::type* = nullptr>
+	typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor lock_get( PRIORITY_T prio ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		sp_carrier->mtx_.lock( prio );
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_, std::adopt_lock );
+		return typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+
+	/**
+	 * @brief try to get single accessor object without blocking
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U this U is base type of T
+	 * @return obj_mutex<U, MTX_T, STORAGE_T>::single_accessor if fail to lock, the accessor is empty( valid() is false ).
+	 */
+	template <typename U = T>
+	typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor try_lock_get( void )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_, std::try_to_lock );
+		if ( !lk_my.owns_lock() ) {
+			return typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		return typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+	template <typename U = T>
+	typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor try_lock_get( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_, std::try_to_lock );
+		if ( !lk_my.owns_lock() ) {
+			return typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		return typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+
+	/**
+	 * @brief try to get single accessor object until the timeout duration has elapsed
+	 *
+	 * This is available if MTX_T is TimedLockable like std::timed_mutex.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U this U is base type of T
+	 * @param timeout_duration maximum duration to block for
+	 * @return obj_mutex<U, MTX_T, STORAGE_T>::single_accessor if fail to lock, the accessor is empty( valid() is false ).
+	 */
+	template <typename U = T, typename Rep, typename Period, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor try_lock_get_for( const std::chrono::duration<Rep, Period>& timeout_duration )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_, timeout_duration );
+		if ( !lk_my.owns_lock() ) {
+			return typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		return typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+	template <typename U = T, typename Rep, typename Period, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor try_lock_get_for( const std::chrono::duration<Rep, Period>& timeout_duration ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_, timeout_duration );
+		if ( !lk_my.owns_lock() ) {
+			return typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		return typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+
+	/**
+	 * @brief try to get single accessor object until the timeout time has been reached
+	 *
+	 * This is available if MTX_T is TimedLockable like std::timed_mutex.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U this U is base type of T
+	 * @param timeout_time maximum time point to block until
+	 * @return obj_mutex<U, MTX_T, STORAGE_T>::single_accessor if fail to lock, the accessor is empty( valid() is false ).
+	 */
+	template <typename U = T, typename Clock, typename Duration, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor try_lock_get_until( const std::chrono::time_point<Clock, Duration>& timeout_time )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_, timeout_time );
+		if ( !lk_my.owns_lock() ) {
+			return typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		return typename obj_mutex<U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+	template <typename U = T, typename Clock, typename Duration, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor try_lock_get_until( const std::chrono::time_point<Clock, Duration>& timeout_time ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		carrier_ptr_t sp_carrier( sp_data_ );
+		auto&         ref_to_data = get_ref<U>();
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &sp_carrier->mtx_ );
+		std::unique_lock<MTX_T> lk_my( sp_carrier->mtx_, timeout_time );
+		if ( !lk_my.owns_lock() ) {
+			return typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &sp_carrier->mtx_ );
+		return typename obj_mutex<const U, MTX_T, STORAGE_T>::single_accessor( std::move( lk_my ), std::move( sp_carrier ), ref_to_data );
+	}
+
+	/**
+	 * @brief get an awaitable that resumes the coroutine with single accessor object when the lock is acquired
+	 *
+	 * This is available if MTX_T supports the asynchronous lock, e.g. obj_async_mutex.
+	 * The coroutine is queued in FIFO order without blocking any thread, and is resumed by ex when the lock is handed over.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U this U is base type of T
+	 * @tparam EXECUTOR_T type of executor that is callable as ex(std::coroutine_handle<>)
+	 * @param ex executor to resume the coroutine
+	 * @return awaitable. co_await returns obj_mutex<U, MTX_T, STORAGE_T>::single_accessor
+	 */
+	template <typename U = T, typename MTX_U = MTX_T, typename EXECUTOR_T = typename MTX_U::inline_executor>
+	typename MTX_U::template lock_awaitable<U, STORAGE_T, EXECUTOR_T> co_lock_get( EXECUTOR_T ex = EXECUTOR_T() )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+		return typename MTX_U::template lock_awaitable<U, STORAGE_T, EXECUTOR_T>( sp_data_, sp_data_->mtx_, get_ref<U>(), std::move( ex ) );
+	}
+
+#if __cplusplus >= 201402L
+	/**
+	 * @brief get read accessor object that holds a shared lock
+	 *
+	 * This is available if MTX_T is SharedLockable like std::shared_mutex.
+	 * Some threads are able to hold read_accessor at the same time.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U this U is base type of T or same to T
+	 * @return obj_mutex<U, MTX_T, STORAGE_T>::read_accessor
+	 */
+	template <typename U = T, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	typename obj_mutex<U, MTX_T, STORAGE_T>::read_accessor lock_get_shared( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		std::shared_lock<MTX_T> lk_my( sp_data_->mtx_ );
+		return typename obj_mutex<U, MTX_T, STORAGE_T>::read_accessor( std::move( lk_my ), sp_data_, get_ref<U>() );
+	}
+
+	/**
+	 * @brief get upgradable accessor object that holds an upgrade lock
+	 *
+	 * This is available if MTX_T has the upgrade lock like obj_upgradable_mutex.
+	 * The reader that may modify the object uses this instead of lock_get(), then the read runs concurrently with read_accessors,
+	 * and only the modification by upgradable_accessor::upgrade() waits for them.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U this U is base type of T or same to T
+	 * @return obj_mutex<U, MTX_T, STORAGE_T>::upgradable_accessor
+	 */
+	template <typename U = T, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_upgrade_lockable<MTX_U>::value>::type* = nullptr>
+	typename obj_mutex<U, MTX_T, STORAGE_T>::upgradable_accessor lock_get_upgradable( void )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		U& ref = get_ref<U>();   // bad_castは、lockする前に送出する。
+		sp_data_->mtx_.lock_upgrade();
+		return typename obj_mutex<U, MTX_T, STORAGE_T>::upgradable_accessor( sp_data_->mtx_, sp_data_, ref );
+	}
+#endif
+
+	/**
+	 * @brief call f with the reference of a target object under the lock
+	 *
+	 * Different from lock_get(), this does not make any accessor object and does not copy std::shared_ptr.
+	 * Therefore the cost is only the lock and unlock of the mutex.
+	 * The reference passed to f should not be kept after f returns.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam F type of callable object that is callable as f(T&)
+	 * @param f callable object
+	 * @return return value of f
+	 */
+	template <typename F>
+	auto with_lock( F&& f ) -> decltype( std::forward<F>( f )( std::declval<T&>() ) )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		std::lock_guard<MTX_T> lk_my( sp_data_->mtx_ );
+		return std::forward<F>( f )( *p_data_ );
+	}
+	template <typename F>
+	auto with_lock( F&& f ) const -> decltype( std::forward<F>( f )( std::declval<const T&>() ) )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		std::lock_guard<MTX_T> lk_my( sp_data_->mtx_ );
+		return std::forward<F>( f )( static_cast<const T&>( *p_data_ ) );
+	}
+
+	/**
+	 * @brief get a buffer of pending operations that are applied under one lock
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @param max_pending the number of pending operations that triggers the automatic flush
+	 * @return batch_buffer
+	 */
+	batch_buffer batch( std::size_t max_pending = 64 )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+		return batch_buffer( sp_data_, sp_data_->mtx_, *p_data_, max_pending );
+	}
+
+	/**
+	 * @brief call f with the reference of a target object by the delegation to the lock holder
+	 *
+	 * This is available if MTX_T provides apply(), e.g. obj_combining_mutex.
+	 * f may be called by other thread that holds the lock. The return value and the exception of f are passed to the caller.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam F type of callable object that is callable as f(T&)
+	 * @param f callable object
+	 * @return return value of f
+	 */
+	template <typename F, typename MTX_U = MTX_T>
+	auto apply( F&& f ) -> decltype( std::declval<MTX_U&>().apply( std::declval<T&>(), std::forward<F>( f ) ) )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+		return sp_data_->mtx_.apply( *p_data_, std::forward<F>( f ) );
+	}
+
+#if __cplusplus >= 201402L
+	/**
+	 * @brief call f with the const reference of a target object under the shared lock
+	 *
+	 * This is available if MTX_T is SharedLockable like std::shared_mutex.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam F type of callable object that is callable as f(const T&)
+	 * @param f callable object
+	 * @return return value of f
+	 */
+	template <typename F, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	auto with_lock_shared( F&& f ) const -> decltype( std::forward<F>( f )( std::declval<const T&>() ) )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		std::shared_lock<MTX_T> lk_my( sp_data_->mtx_ );
+		return std::forward<F>( f )( static_cast<const T&>( *p_data_ ) );
+	}
+#endif
+
+	/**
+	 * @brief make a clone object
+	 *
+	 * there is no exclusive control b/w the cloned object and this object.
+	 *
+	 * @tparam U type that will clone to
+	 * @tparam MTX_U type of mutex
+	 * @tparam STORAGE_U storage policy of a cloned object
+	 * @return obj_mutex<U, MTX_U, STORAGE_U> a cloned object
+	 */
+	template <typename U = T, typename MTX_U = MTX_T, typename STORAGE_U = STORAGE_T, typename std::enable_if<std::is_convertible<T, U>::value>::type* = nullptr>
+	obj_mutex<U, MTX_U, STORAGE_U> clone( void ) const
+	{
+		return obj_mutex<U, MTX_U, STORAGE_U>( lock_get().ref() );
+	}
+
+	/**
+	 * @brief make a clone object whose carrier is allocated by alloc
+	 *
+	 * If a pool allocator, e.g. std::pmr::polymorphic_allocator with a pool resource, is passed, the clone does not use the global heap for its carrier.
+	 *
+	 * @tparam U type that will clone to
+	 * @tparam MTX_U type of mutex
+	 * @tparam STORAGE_U storage policy of a cloned object. inline_storage is not available.
+	 * @tparam ALLOC type of allocator
+	 * @param alloc allocator
+	 * @return obj_mutex<U, MTX_U, STORAGE_U> a cloned object
+	 */
+	template <typename U = T, typename MTX_U = MTX_T, typename STORAGE_U = STORAGE_T, typename ALLOC,
+	          typename std::enable_if<std::is_convertible<T, U>::value && !std::is_same<STORAGE_U, inline_storage>::value>::type* = nullptr>
+	obj_mutex<U, MTX_U, STORAGE_U> clone( std::allocator_arg_t, const ALLOC& alloc ) const
+	{
+		return obj_mutex<U, MTX_U, STORAGE_U>( std::allocator_arg, alloc, lock_get().ref() );
+	}
+
+	/**
+	 * @brief copy-assign a target object to the target object of dst
+	 *
+	 * Different from clone(), this does not allocate a new carrier. The existing object of dst is reused by the copy assignment,
+	 * e.g. std::vector reuses its capacity.
+	 * Both mutexes are locked in the order of the address, or of the rank for obj_ranked_mutex, while copying.
+	 * Therefore this does not deadlock with clone_into() in the opposite direction.
+	 *
+	 * if this object or dst is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam U type of the target object of dst
+	 * @tparam MTX_U type of mutex of dst
+	 * @tparam STORAGE_U storage policy of dst
+	 * @param dst destination
+	 */
+	template <typename U, typename MTX_U, typename STORAGE_U, typename std::enable_if<std::is_assignable<U&, const T&>::value>::type* = nullptr>
+	void clone_into( obj_mutex<U, MTX_U, STORAGE_U>& dst ) const
+	{
+		obj_mutex_impl::ordered_lock_pair<MTX_T, MTX_U> lk( get_mtx_for_lock_all(), dst.get_mtx_for_lock_all() );
+		dst.get_data_for_clone_into() = static_cast<const T&>( *p_data_ );
+	}
+
+	/**
+	 * @brief make a shered clone object
+	 *
+	 * there is the exclusive control b/w the cloned object and this object.
+	 *
+	 * @return obj_mutex  a cloned object that shares a mutex
+	 */
+	template <typename U = T, typename std::enable_if<std::is_same<U, T>::value>::type* = nullptr>
+	obj_mutex<U, MTX_T, STORAGE_T> shared_clone( void ) const
+	{
+		return obj_mutex<U, MTX_T, STORAGE_T>( sp_data_, p_data_ );
+	}
+
+	/**
+	 * @brief make a shered clone object
+	 *
+	 * there is the exclusive control b/w the cloned object and this object.
+	 *
+	 * @return obj_mutex  a cloned object that shares a mutex
+	 *
+	 * @exception std::bad_cast fail to down-cast from T/U to U/T. This means U/T is not derived class of T/U
+	 */
+	template <typename U = T, typename std::enable_if<!std::is_same<U, T>::value && ( std::is_base_of<U, T>::value || std::is_base_of<T, U>::value )>::type* = nullptr>
+	obj_mutex<U, MTX_T, STORAGE_T> shared_clone( void ) const
+	{
+		U* p_U_tmp = get_ptr<U>();
+		if ( p_U_tmp == nullptr ) {
+			throw std::bad_cast();
+		}
+		return obj_mutex<U, MTX_T, STORAGE_T>( sp_data_, p_U_tmp );
+	}
+
+	/**
+	 * @brief check this is locked or not
+	 *
+	 * The answer may be stale when this returns. To acquire the lock without blocking, use try_lock_get().
+	 *
+	 * @return true
+	 * @return false
+	 */
+	bool is_locked( void ) const
+	{
+		bool ans = sp_data_->mtx_.try_lock();
+		if ( ans ) {
+			sp_data_->mtx_.unlock();
+		}
+		return !ans;
+	}
+
+	/**
+	 * @brief get the statistics of the mutex
+	 *
+	 * This is available if MTX_T provides stats(), e.g. obj_instrumented_mutex.
+	 * The objects that share a carrier by shared_clone() return the same statistics.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @return the return value of MTX_T::stats()
+	 */
+	template <typename MTX_U = MTX_T>
+	auto stats( void ) const -> decltype( std::declval<const MTX_U&>().stats() )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+		return sp_data_->mtx_.stats();
+	}
+
+	/**
+	 * @brief wake up one of the accessors that wait by single_accessor::wait()
+	 *
+	 * This is available if MTX_T has the condition variable, e.g. obj_condition_mutex.
+	 * The objects that share a carrier by shared_clone() share the condition variable.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 */
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_condition_waitable<MTX_U>::value>::type* = nullptr>
+	void notify_one( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+		sp_data_->mtx_.notify_one();
+	}
+
+	/**
+	 * @brief wake up all of the accessors that wait by single_accessor::wait()
+	 *
+	 * This is available if MTX_T has the condition variable, e.g. obj_condition_mutex.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 */
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_condition_waitable<MTX_U>::value>::type* = nullptr>
+	void notify_all( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+		sp_data_->mtx_.notify_all();
+	}
+
+	/**
+	 * @brief modify a target object by f, and publish it to optimistic_read() without the data race
+	 *
+	 * This is available if T is trivially copyable and MTX_T has the sequence counter, e.g. obj_seqlock_mutex.
+	 * f modifies a copy under the lock, and the copy is stored back by the relaxed atomic stores.
+	 * Writes through lock_get() or with_lock() are plain stores, so they race with optimistic_read() in the sense of the memory model.
+	 * Use this when optimistic_read() may run at the same time.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam F type of callable object that is callable as f(T&)
+	 * @param f callable object
+	 */
+	template <typename F, typename U = T, typename MTX_U = MTX_T,
+	          typename std::enable_if<std::is_trivially_copyable<U>::value && obj_mutex_impl::is_seq_lockable<MTX_U>::value>::type* = nullptr>
+	void publish( F&& f )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		std::lock_guard<MTX_T> lk( sp_data_->mtx_ );
+
+		T tmp( *p_data_ );   // lockの保持者だけが書き込むため、通常のコピーでよい。
+		f( tmp );
+		obj_mutex_impl::seqlock_write( *p_data_, tmp );
+	}
+
+	/**
+	 * @brief get a copy of a target object without locking
+	 *
+	 * This is available if T is trivially copyable and MTX_T has the sequence counter, e.g. obj_seqlock_mutex.
+	 * This does not write any shared cache line, and it retries when a writer modifies the object while copying.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @return a copy of a target object
+	 */
+	template <typename U = T, typename MTX_U = MTX_T,
+	          typename std::enable_if<std::is_trivially_copyable<U>::value && obj_mutex_impl::is_seq_lockable<MTX_U>::value>::type* = nullptr>
+	typename std::remove_cv<T>::type optimistic_read( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+		return obj_mutex_impl::seqlock_read<typename std::remove_cv<T>::type>( sp_data_->mtx_, *p_data_ );
+	}
+
+	/**
+	 * @brief load the value of std::atomic without the mutex
+	 *
+	 * This is available if T is std::atomic of a non-class type that is lock-free, e.g. obj_mutex<std::atomic<int>>.
+	 * lock_get() is also available, and the accessor provides std::atomic<X>&. Therefore the lock-free operations and the accessors do not race.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @param order memory order
+	 * @return the value
+	 */
+	template <typename U = T, typename std::enable_if<obj_mutex_impl::is_lock_free_atomic<U>::value>::type* = nullptr>
+	typename obj_mutex_impl::is_lock_free_atomic<U>::value_type load( std::memory_order order = std::memory_order_seq_cst ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		return p_data_->load( order );
+	}
+
+	/**
+	 * @brief update the value of std::atomic by f without the mutex
+	 *
+	 * This is the CAS loop, so f may be called more than once and should not have side effects.
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 *
+	 * @tparam F type of callable object that is callable as f(X) and returns X
+	 * @param f callable object that returns a new value from the old value
+	 * @param order memory order of the successful update
+	 * @return the old value
+	 */
+	template <typename F, typename U = T, typename std::enable_if<obj_mutex_impl::is_lock_free_atomic<U>::value>::type* = nullptr>
+	typename obj_mutex_impl::is_lock_free_atomic<U>::value_type fetch_update( F f, std::memory_order order = std::memory_order_seq_cst )
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+
+		return obj_mutex_impl::atomic_fetch_update( *p_data_, f, order );
+	}
+
+private:
+	using storage_traits_t = obj_mutex_impl::storage_traits<STORAGE_T, MTX_T>;
+	using carrier_ptr_t    = typename storage_traits_t::carrier_ptr_t;
+	template <typename U>
+	using carrier_t = typename storage_traits_t::template carrier_t<U>;
+
+	struct carrier_tag {};
+
+	template <typename CARRIER_PTR_T>
+	obj_mutex( carrier_tag, CARRIER_PTR_T&& sp_carrier_arg )
+	  : p_data_( obj_mutex_impl::get_data_ptr( sp_carrier_arg.get() ) )
+	  , sp_data_( std::move( sp_carrier_arg ) )
+	{
+	}
+
+	obj_mutex( const carrier_ptr_t& sp_data_arg, T* p_data_arg )
+	  : p_data_( p_data_arg )
+	  , sp_data_( sp_data_arg )
+	{
+	}
+
+	// コピーコンストラクタを定義した場合、文脈上、2つの振る舞いが利用者の期待値として存在しうる。
+	// (1)保持している型Tの実体のコピー=複製。いわゆる深いコピー。
+	//    既存のインスタントと異なるオブジェクトが生成される＝排他制御は分離される。
+	// (2)排他制御を行うためのアクセスポイントとしての複製。いわゆる浅いコピー。
+	//
+	// obj_mutexの趣旨として、データ実体はアクセスは、single_accessor経由でアクセスすべきである。
+	// この点を踏まえると、(1)を実装すべきと考えられるが、一方でコードの見た目として(2)のと区別が不明である。
+	// よって、コピーコンストラクタ、copy assignmentは定義しない。
+	// (1)相当の機能は、clone()で提供する。
+	// (2)相当の機能は、shared_clone()で提供する。
+	obj_mutex( const obj_mutex& orig )            = delete;
+	obj_mutex& operator=( const obj_mutex& orig ) = delete;
+
+	/**
+	 * @brief get a pointer of U with up-cast or no cast
+	 *
+	 * This uses the cached pointer. Therefore there is no RTTI and no reference count operation.
+	 */
+	template <typename U, typename std::enable_if<std::is_base_of<U, T>::value || std::is_same<U, T>::value>::type* = nullptr>
+	U* get_ptr( void ) const
+	{
+		return p_data_;
+	}
+
+	/**
+	 * @brief get a pointer of U with down cast
+	 *
+	 * @return U* nullptr if fail to down-cast
+	 */
+	template <typename U, typename std::enable_if<!( std::is_base_of<U, T>::value || std::is_same<U, T>::value )>::type* = nullptr>
+	U* get_ptr( void ) const
+	{
+		return storage_traits_t::template down_cast<U>( sp_data_.get(), p_data_ );
+	}
+
+	template <typename U>
+	U& get_ref( void )
+	{
+		U* p_ans = get_ptr<U>();
+		if ( p_ans == nullptr ) {
+			throw std::bad_cast();
+		}
+		return *p_ans;
+	}
+
+	template <typename U>
+	const U& get_ref( void ) const
+	{
+		U* p_ans = get_ptr<U>();
+		if ( p_ans == nullptr ) {
+			throw std::bad_cast();
+		}
+		return *p_ans;
+	}
+
+	/**
+	 * @brief get the mutex for lock_get_all()
+	 *
+	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 */
+	MTX_T& get_mtx_for_lock_all( void ) const
+	{
+		if ( sp_data_ == nullptr ) {
+			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
+		}
+		return sp_data_->mtx_;
+	}
+
+	/**
+	 * @brief make single accessor with the mutex that has been locked by lock_get_all()
+	 *
+	 * @param owns_lock true: the accessor adopts the lock. false: the lock is owned by other accessor that shares the carrier.
+	 */
+	single_accessor adopt_lock_get( bool owns_lock )
+	{
+		std::unique_lock<MTX_T> lk_my;
+		if ( owns_lock ) {
+			lk_my = std::unique_lock<MTX_T>( sp_data_->mtx_, std::adopt_lock );
+		}
+		return single_accessor( std::move( lk_my ), sp_data_, *p_data_ );
+	}
+
+	/**
+	 * @brief get the target object for clone_into(). The caller should hold the lock by get_mtx_for_lock_all().
+	 */
+	T& get_data_for_clone_into( void )
+	{
+		return *p_data_;
+	}
+
+	T*            p_data_;   // キャッシュしたデータ実体へのポインタ。lock_get()でRTTIを使わないようにするため。
+	carrier_ptr_t sp_data_;
+
+	template <typename U, typename MTX_U, typename STORAGE_U>
+	friend class obj_mutex;
+	friend struct obj_mutex_impl::lock_all_helper;
+};
+
+/**
+ * @brief obj_mutex with inline_storage
+ *
+ * The carrier is embedded in this object. Therefore there is no heap allocation.
+ * Instead, this object is not movable, and shared_clone(), up-cast move and down-cast are not available.
+ * Accessors borrow the carrier, so accessors should not outlive this object.
+ *
+ * @tparam T type of the target object
+ * @tparam MTX_T type of mutex
+ */
+template <typename T, typename MTX_T>
+class obj_mutex<T, MTX_T, inline_storage> {
+public:
+	using single_accessor = obj_mutex_impl::single_accessor<T, MTX_T, inline_storage>;
+	using batch_buffer    = obj_mutex_impl::batch_buffer<T, MTX_T, inline_storage>;
+#if __cplusplus >= 201402L
+	using read_accessor       = obj_mutex_impl::read_accessor<T, MTX_T, inline_storage>;
+	using upgradable_accessor = obj_mutex_impl::upgradable_accessor<T, MTX_T, inline_storage>;
+#endif
+
+	/**
+	 * @brief Default constructor of a new obj mutex object
+	 *
+	 * If T has a default constructor, this default constructor is defined.
+	 *
+	 * @tparam U
+	 */
+	template <typename U = T, typename std::enable_if<std::is_default_constructible<U>::value>::type* = nullptr>
+	obj_mutex( void )
+	  : carrier_()
+	{
+	}
+
+	/**
+	 * @brief Construct a new obj mutex object
+	 *
+	 * Construct with using T(headarg, args...)
+	 *
+	 * @tparam HEADArg this is a type of 1st argument, and is not type of obj_mutex
+	 * @tparam Args these are the types of 2nd and more arguments
+	 * @param headarg 1st argument of T's constructor
+	 * @param args 2nd and more arguments of T's constructor
+	 */
+	template <typename HEADArg, typename... Args,
+	          typename std::enable_if<
+				  !std::is_same<
+					  obj_mutex,
+					  typename std::remove_cv<
+						  typename std::remove_reference<HEADArg>::type>::type>::value>::type* = nullptr>
+	obj_mutex( HEADArg&& headarg, Args&&... args )
+	  : carrier_( std::forward<HEADArg>( headarg ), std::forward<Args>( args )... )
+	{
+	}
 
-	//////////////////////
 	/**
-	 * @brief Default constructor of a new obj mutex object
+	 * @brief check the validity
 	 *
-	 * If T has a default constructor, this default constructor is defined.
+	 * @return true always true, because this object is not movable.
+	 */
+	bool valid( void ) const
+	{
+		return true;
+	}
+
+	/**
+	 * @brief get single accessor object with up-cast
 	 *
-	 * @tparam U
+	 * @tparam U this U is base type of T or same to T
+	 * @return single_accessor of U
 	 */
-	template <typename U = T, typename std::enable_if<std::is_default_constructible<U>::value && std::is_class<U>::value>::type* = nullptr>
-	obj_mutex( void )
-	  : sp_data_( std::make_shared<data_carrier_class<U, MTX_T>>() )
+	template <typename U = T, typename std::enable_if<std::is_base_of<U, T>::value || std::is_same<U, T>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<U, MTX_T, inline_storage> lock_get( void )
 	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_ );
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		return obj_mutex_impl::single_accessor<U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
+	}
+	template <typename U = T, typename std::enable_if<std::is_base_of<U, T>::value || std::is_same<U, T>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage> lock_get( void ) const
+	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_ );
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		return obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
 	}
 
 	/**
-	 * @brief Default constructor of a new obj mutex object
+	 * @brief get single accessor object with up-cast by locking with a priority
 	 *
-	 * If T has a default constructor, this default constructor is defined.
+	 * This is available if MTX_T can be locked with a priority, e.g. obj_fair_mutex and obj_lock_priority.
 	 *
-	 * @tparam U
+	 * @tparam U this U is base type of T or same to T
+	 * @param prio priority that is passed to MTX_T::lock()
+	 * @return single_accessor of U
 	 */
-	template <typename U = T, typename std::enable_if<std::is_default_constructible<U>::value && !std::is_class<U>::value>::type* = nullptr>
-	obj_mutex( void )
-	  : sp_data_( std::make_shared<data_carrier_non_class<U, MTX_T>>() )
+	template <typename U = T, typename PRIORITY_T, typename MTX_U = MTX_T,
+	          typename std::enable_if<( std::is_base_of<U, T>::value || std::is_same<U, T>::value ) && obj_mutex_impl::is_priority_lockable<MTX_U, PRIORITY_T>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<U, MTX_T, inline_storage> lock_get( PRIORITY_T prio )
+	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		carrier_.mtx_.lock( prio );
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_, std::adopt_lock );
+		return obj_mutex_impl::single_accessor<U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
+	}
+	template <typename U = T, typename PRIORITY_T, typename MTX_U = MTX_T,
+	          typename std::enable_if<( std::is_base_of<U, T>::value || std::is_same<U, T>::value ) && obj_mutex_impl::is_priority_lockable<MTX_U, PRIORITY_T>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage> lock_get( PRIORITY_T prio ) const
 	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		carrier_.mtx_.lock( prio );
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_, std::adopt_lock );
+		return obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
 	}
 
 	/**
-	 * @brief Move constructor of a new obj mutex object with up-cast or no cast
+	 * @brief try to get single accessor object with up-cast without blocking
 	 *
-	 * @tparam U original type of move
-	 * @tparam std::enable_if<std::is_base_of<T, U>::value>::type
-	 * @param orig
+	 * @tparam U this U is base type of T or same to T
+	 * @return single_accessor of U. if fail to lock, the accessor is empty( valid() is false ).
 	 */
-	template <typename U, typename std::enable_if<std::is_base_of<T, U>::value || std::is_same<T, U>::value>::type* = nullptr>
-	obj_mutex( obj_mutex<U, MTX_T>&& orig )
-	  : sp_data_( std::move( orig.sp_data_ ) )
+	template <typename U = T, typename std::enable_if<std::is_base_of<U, T>::value || std::is_same<U, T>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<U, MTX_T, inline_storage> try_lock_get( void )
+	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_, std::try_to_lock );
+		if ( !lk_my.owns_lock() ) {
+			return obj_mutex_impl::single_accessor<U, MTX_T, inline_storage>();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		return obj_mutex_impl::single_accessor<U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
+	}
+	template <typename U = T, typename std::enable_if<std::is_base_of<U, T>::value || std::is_same<U, T>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage> try_lock_get( void ) const
 	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_, std::try_to_lock );
+		if ( !lk_my.owns_lock() ) {
+			return obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage>();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		return obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
 	}
 
 	/**
-	 * @brief Move constructor of a new obj mutex object with down cast
+	 * @brief try to get single accessor object with up-cast until the timeout duration has elapsed
 	 *
-	 * @tparam U original type of move
-	 * @tparam std::enable_if<std::is_base_of<T, U>::value>::type
-	 * @param orig
+	 * This is available if MTX_T is TimedLockable like std::timed_mutex.
 	 *
-	 * @exception std::bad_cast fail to down-cast from U to T. This means T is not derived class of U
+	 * @tparam U this U is base type of T or same to T
+	 * @return single_accessor of U. if fail to lock, the accessor is empty( valid() is false ).
 	 */
-	template <typename U = T, typename std::enable_if<std::is_base_of<U, T>::value && !std::is_same<T, U>::value>::type* = nullptr>
-	obj_mutex( obj_mutex<U, MTX_T>&& orig )
-	  : sp_data_( std::move( orig.sp_data_ ) )
+	template <typename U = T, typename Rep, typename Period, typename MTX_U = MTX_T, typename std::enable_if<( std::is_base_of<U, T>::value || std::is_same<U, T>::value ) && obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<U, MTX_T, inline_storage> try_lock_get_for( const std::chrono::duration<Rep, Period>& timeout_duration )
 	{
-		T* p_T_tmp = dynamic_cast<T*>( sp_data_.get() );
-		if ( p_T_tmp == nullptr ) {
-			orig.sp_data_ = std::move( sp_data_ );
-			throw std::bad_cast();   // fail to down cast or could not be convertible
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_, timeout_duration );
+		if ( !lk_my.owns_lock() ) {
+			return obj_mutex_impl::single_accessor<U, MTX_T, inline_storage>();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		return obj_mutex_impl::single_accessor<U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
+	}
+	template <typename U = T, typename Rep, typename Period, typename MTX_U = MTX_T, typename std::enable_if<( std::is_base_of<U, T>::value || std::is_same<U, T>::value ) && obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage> try_lock_get_for( const std::chrono::duration<Rep, Period>& timeout_duration ) const
+	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_, timeout_duration );
+		if ( !lk_my.owns_lock() ) {
+			return obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage>();
 		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		return obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
 	}
 
 	/**
-	 * @brief Construct a new obj mutex object
+	 * @brief try to get single accessor object with up-cast until the timeout time has been reached
 	 *
-	 * Construct with using T(headarg, args...)
+	 * This is available if MTX_T is TimedLockable like std::timed_mutex.
 	 *
-	 * @tparam HEADArg this is a type of 1st argument, and is not type of obj_mutex<U>
-	 * @tparam Args these are the types of 2nd and more arguments
-	 * @param headarg 1st argument of T's constructor
-	 * @param args 2nd and more arguments of T's constructor
+	 * @tparam U this U is base type of T or same to T
+	 * @return single_accessor of U. if fail to lock, the accessor is empty( valid() is false ).
 	 */
-	template <typename HEADArg, typename U = T, typename MTX_U = MTX_T, typename... Args,
-	          typename std::enable_if<
-				  !std::is_same<
-					  obj_mutex<U, MTX_U>,
-					  typename std::remove_cv<
-						  typename std::remove_reference<HEADArg>::type>::type>::value &&
-				  std::is_class<U>::value>::type* = nullptr>
-	obj_mutex( HEADArg&& headarg, Args&&... args )
-	  : sp_data_( std::make_shared<data_carrier_class<U, MTX_U>>( std::forward<HEADArg>( headarg ), std::forward<Args>( args )... ) )
+	template <typename U = T, typename Clock, typename Duration, typename MTX_U = MTX_T, typename std::enable_if<( std::is_base_of<U, T>::value || std::is_same<U, T>::value ) && obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<U, MTX_T, inline_storage> try_lock_get_until( const std::chrono::time_point<Clock, Duration>& timeout_time )
+	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_, timeout_time );
+		if ( !lk_my.owns_lock() ) {
+			return obj_mutex_impl::single_accessor<U, MTX_T, inline_storage>();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		return obj_mutex_impl::single_accessor<U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
+	}
+	template <typename U = T, typename Clock, typename Duration, typename MTX_U = MTX_T, typename std::enable_if<( std::is_base_of<U, T>::value || std::is_same<U, T>::value ) && obj_mutex_impl::is_timed_lockable<MTX_U>::value>::type* = nullptr>
+	obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage> try_lock_get_until( const std::chrono::time_point<Clock, Duration>& timeout_time ) const
 	{
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, &carrier_.mtx_ );
+		std::unique_lock<MTX_T> lk_my( carrier_.mtx_, timeout_time );
+		if ( !lk_my.owns_lock() ) {
+			return obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage>();
+		}
+		OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, &carrier_.mtx_ );
+		return obj_mutex_impl::single_accessor<const U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
 	}
 
 	/**
-	 * @brief Construct a new obj mutex object
+	 * @brief get an awaitable that resumes the coroutine with single accessor object when the lock is acquired
 	 *
-	 * Construct with using T(headarg, args...)
+	 * This is available if MTX_T supports the asynchronous lock, e.g. obj_async_mutex.
 	 *
-	 * @tparam HEADArg this is a type of 1st argument, and is not type of obj_mutex<U>
-	 * @tparam Args these are the types of 2nd and more arguments
-	 * @param headarg 1st argument of T's constructor
-	 * @param args 2nd and more arguments of T's constructor
+	 * @tparam U this U is base type of T or same to T
+	 * @tparam EXECUTOR_T type of executor that is callable as ex(std::coroutine_handle<>)
+	 * @param ex executor to resume the coroutine
+	 * @return awaitable. co_await returns single_accessor of U
 	 */
-	template <typename HEADArg, typename U = T, typename MTX_U = MTX_T, typename... Args,
-	          typename std::enable_if<
-				  !std::is_same<
-					  obj_mutex<U, MTX_U>,
-					  typename std::remove_cv<
-						  typename std::remove_reference<HEADArg>::type>::type>::value &&
-				  !std::is_class<U>::value>::type* = nullptr>
-	obj_mutex( HEADArg&& headarg, Args&&... args )
-	  : sp_data_( std::make_shared<data_carrier_non_class<U, MTX_U>>( std::forward<HEADArg>( headarg ), std::forward<Args>( args )... ) )
+	template <typename U = T, typename MTX_U = MTX_T, typename EXECUTOR_T = typename MTX_U::inline_executor,
+	          typename std::enable_if<std::is_base_of<U, T>::value || std::is_same<U, T>::value>::type* = nullptr>
+	typename MTX_U::template lock_awaitable<U, inline_storage, EXECUTOR_T> co_lock_get( EXECUTOR_T ex = EXECUTOR_T() )
 	{
+		return typename MTX_U::template lock_awaitable<U, inline_storage, EXECUTOR_T>( &carrier_, carrier_.mtx_, carrier_.data_, std::move( ex ) );
 	}
 
+#if __cplusplus >= 201402L
 	/**
-	 * @brief move assignmment with up-cast or no cast
+	 * @brief get read accessor object that holds a shared lock
 	 *
-	 * @param orig
-	 * @return obj_mutex&
+	 * This is available if MTX_T is SharedLockable like std::shared_mutex.
+	 *
+	 * @tparam U this U is base type of T or same to T
+	 * @return read_accessor of U
 	 */
-	template <typename U, typename std::enable_if<std::is_base_of<T, U>::value || std::is_same<T, U>::value>::type* = nullptr>
-	obj_mutex& operator=( obj_mutex<U, MTX_T>&& orig )
+	template <typename U = T, typename MTX_U = MTX_T,
+	          typename std::enable_if<( std::is_base_of<U, T>::value || std::is_same<U, T>::value ) &&
+	                                  obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	obj_mutex_impl::read_accessor<U, MTX_T, inline_storage> lock_get_shared( void ) const
 	{
-		sp_data_ = std::move( orig.sp_data_ );
-		return *this;
+		std::shared_lock<MTX_T> lk_my( carrier_.mtx_ );
+		return obj_mutex_impl::read_accessor<U, MTX_T, inline_storage>( std::move( lk_my ), &carrier_, carrier_.data_ );
 	}
 
 	/**
-	 * @brief move assignmment
+	 * @brief get upgradable accessor object that holds an upgrade lock
 	 *
-	 * @param orig
-	 * @return obj_mutex&
+	 * This is available if MTX_T has the upgrade lock like obj_upgradable_mutex.
 	 *
-	 * @exception std::bad_cast fail to down-cast from U to T. This means T is not derived class of U
+	 * @tparam U this U is base type of T or same to T
+	 * @return upgradable_accessor of U
 	 */
-	template <typename U, typename std::enable_if<std::is_base_of<U, T>::value && !std::is_same<T, U>::value>::type* = nullptr>
-	obj_mutex& operator=( obj_mutex<U, MTX_T>&& orig )
+	template <typename U = T, typename MTX_U = MTX_T,
+	          typename std::enable_if<( std::is_base_of<U, T>::value || std::is_same<U, T>::value ) &&
+	                                  obj_mutex_impl::is_upgrade_lockable<MTX_U>::value>::type* = nullptr>
+	obj_mutex_impl::upgradable_accessor<U, MTX_T, inline_storage> lock_get_upgradable( void )
 	{
-		T* p_T_tmp = dynamic_cast<T*>( orig.sp_data_.get() );
-		if ( p_T_tmp == nullptr ) {
-			throw std::bad_cast();   // fail to down cast or could not be convertible
-		}
-		sp_data_ = std::move( orig.sp_data_ );
-		return *this;
+		carrier_.mtx_.lock_upgrade();
+		return obj_mutex_impl::upgradable_accessor<U, MTX_T, inline_storage>( carrier_.mtx_, &carrier_, carrier_.data_ );
 	}
+#endif
 
 	/**
-	 * @brief check the validity
+	 * @brief call f with the reference of a target object under the lock
 	 *
-	 * @return true this has a valid object
-	 * @return false this does not have any valid object. e.g. this will happen after move
+	 * @tparam F type of callable object that is callable as f(T&)
+	 * @param f callable object
+	 * @return return value of f
 	 */
-	bool valid( void ) const
+	template <typename F>
+	auto with_lock( F&& f ) -> decltype( std::forward<F>( f )( std::declval<T&>() ) )
 	{
-		return ( sp_data_ != nullptr );
+		std::lock_guard<MTX_T> lk_my( carrier_.mtx_ );
+		return std::forward<F>( f )( carrier_.data_ );
+	}
+	template <typename F>
+	auto with_lock( F&& f ) const -> decltype( std::forward<F>( f )( std::declval<const T&>() ) )
+	{
+		std::lock_guard<MTX_T> lk_my( carrier_.mtx_ );
+		return std::forward<F>( f )( static_cast<const T&>( carrier_.data_ ) );
 	}
 
 	/**
-	 * @brief get single accessor object with up-cast
+	 * @brief get a buffer of pending operations that are applied under one lock
 	 *
-	 * if this object is not valid( valid() is flase ), this throws std::logic_error
+	 * The buffer borrows the carrier, so it should not outlive this object.
 	 *
-	 * @tparam U this U is base type of T
-	 * @return obj_mutex<U, MTX_T>::single_accessor
+	 * @param max_pending the number of pending operations that triggers the automatic flush
+	 * @return batch_buffer
 	 */
-	template <typename U = T>
-	typename obj_mutex<U, MTX_T>::single_accessor lock_get( void )
+	batch_buffer batch( std::size_t max_pending = 64 )
 	{
-		// 型Tの基底クラスUへのアップキャストされたsingle_accessorを得る
-		if ( sp_data_ == nullptr ) {
-			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
-		}
-
-		std::unique_lock<MTX_T> lk_my( sp_data_->mtx_ );
-		return typename obj_mutex<U, MTX_T>::single_accessor( std::move( lk_my ), sp_data_, get_ref<U>() );
+		return batch_buffer( &carrier_, carrier_.mtx_, carrier_.data_, max_pending );
 	}
-	template <typename U = T>
-	typename obj_mutex<const U, MTX_T>::single_accessor lock_get( void ) const
+
+	/**
+	 * @brief call f with the reference of a target object by the delegation to the lock holder
+	 *
+	 * This is available if MTX_T provides apply(), e.g. obj_combining_mutex.
+	 *
+	 * @tparam F type of callable object that is callable as f(T&)
+	 * @param f callable object
+	 * @return return value of f
+	 */
+	template <typename F, typename MTX_U = MTX_T>
+	auto apply( F&& f ) -> decltype( std::declval<MTX_U&>().apply( std::declval<T&>(), std::forward<F>( f ) ) )
 	{
-		// 型Tの基底クラスUへのアップキャストされたsingle_accessorを得る
-		if ( sp_data_ == nullptr ) {
-			throw std::logic_error( "obj_mutex is empty. has been moved ?" );
-		}
+		return carrier_.mtx_.apply( carrier_.data_, std::forward<F>( f ) );
+	}
 
-		std::unique_lock<MTX_T> lk_my( sp_data_->mtx_ );
-		return typename obj_mutex<const U, MTX_T>::single_accessor( std::move( lk_my ), sp_data_, get_ref<U>() );
+#if __cplusplus >= 201402L
+	/**
+	 * @brief call f with the const reference of a target object under the shared lock
+	 *
+	 * This is available if MTX_T is SharedLockable like std::shared_mutex.
+	 *
+	 * @tparam F type of callable object that is callable as f(const T&)
+	 * @param f callable object
+	 * @return return value of f
+	 */
+	template <typename F, typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	auto with_lock_shared( F&& f ) const -> decltype( std::forward<F>( f )( std::declval<const T&>() ) )
+	{
+		std::shared_lock<MTX_T> lk_my( carrier_.mtx_ );
+		return std::forward<F>( f )( static_cast<const T&>( carrier_.data_ ) );
 	}
+#endif
 
 	/**
 	 * @brief make a clone object
 	 *
 	 * there is no exclusive control b/w the cloned object and this object.
+	 * If STORAGE_U is inline_storage, C++17 or later is required, because obj_mutex with inline_storage is not movable.
 	 *
 	 * @tparam U type that will clone to
 	 * @tparam MTX_U type of mutex
-	 * @return obj_mutex<U, MTX_U> a cloned object
+	 * @tparam STORAGE_U storage policy of a cloned object
+	 * @return obj_mutex<U, MTX_U, STORAGE_U> a cloned object
 	 */
-	template <typename U = T, typename MTX_U = MTX_T, typename std::enable_if<std::is_convertible<T, U>::value>::type* = nullptr>
-	obj_mutex<U, MTX_U> clone( void ) const
+	template <typename U = T, typename MTX_U = MTX_T, typename STORAGE_U = inline_storage, typename std::enable_if<std::is_convertible<T, U>::value>::type* = nullptr>
+	obj_mutex<U, MTX_U, STORAGE_U> clone( void ) const
 	{
-		return obj_mutex<U, MTX_U>( lock_get().ref() );
+		return obj_mutex<U, MTX_U, STORAGE_U>( lock_get().ref() );
 	}
 
 	/**
-	 * @brief make a shered clone object
+	 * @brief make a clone object whose carrier is allocated by alloc
 	 *
-	 * there is the exclusive control b/w the cloned object and this object.
-	 *
-	 * @return obj_mutex  a cloned object that shares a mutex
+	 * @tparam U type that will clone to
+	 * @tparam MTX_U type of mutex
+	 * @tparam STORAGE_U storage policy of a cloned object. inline_storage is not available.
+	 * @tparam ALLOC type of allocator
+	 * @param alloc allocator
+	 * @return obj_mutex<U, MTX_U, STORAGE_U> a cloned object
 	 */
-	template <typename U = T, typename std::enable_if<std::is_same<U, T>::value>::type* = nullptr>
-	obj_mutex<U, MTX_T> shared_clone( void ) const
+	template <typename U = T, typename MTX_U = MTX_T, typename STORAGE_U = shared_storage, typename ALLOC,
+	          typename std::enable_if<std::is_convertible<T, U>::value && !std::is_same<STORAGE_U, inline_storage>::value>::type* = nullptr>
+	obj_mutex<U, MTX_U, STORAGE_U> clone( std::allocator_arg_t, const ALLOC& alloc ) const
 	{
-		return obj_mutex<U, MTX_T>( sp_data_ );
+		return obj_mutex<U, MTX_U, STORAGE_U>( std::allocator_arg, alloc, lock_get().ref() );
 	}
 
 	/**
-	 * @brief make a shered clone object
-	 *
-	 * there is the exclusive control b/w the cloned object and this object.
+	 * @brief copy-assign a target object to the target object of dst
 	 *
-	 * @return obj_mutex  a cloned object that shares a mutex
+	 * Both mutexes are locked in the order of the address, or of the rank for obj_ranked_mutex, while copying.
+	 * Therefore this does not deadlock with clone_into() in the opposite direction.
 	 *
-	 * @exception std::bad_cast fail to down-cast from T/U to U/T. This means U/T is not derived class of T/U
+	 * @tparam U type of the target object of dst
+	 * @tparam MTX_U type of mutex of dst
+	 * @tparam STORAGE_U storage policy of dst
+	 * @param dst destination
 	 */
-	template <typename U = T, typename std::enable_if<!std::is_same<U, T>::value && ( std::is_base_of<U, T>::value || std::is_base_of<T, U>::value )>::type* = nullptr>
-	obj_mutex<U, MTX_T> shared_clone( void ) const
+	template <typename U, typename MTX_U, typename STORAGE_U, typename std::enable_if<std::is_assignable<U&, const T&>::value>::type* = nullptr>
+	void clone_into( obj_mutex<U, MTX_U, STORAGE_U>& dst ) const
 	{
-		U* p_U_tmp = dynamic_cast<U*>( sp_data_.get() );
-		if ( p_U_tmp == nullptr ) {
-			throw std::bad_cast();
-		}
-		return obj_mutex<U, MTX_T>( sp_data_ );
+		obj_mutex_impl::ordered_lock_pair<MTX_T, MTX_U> lk( carrier_.mtx_, dst.get_mtx_for_lock_all() );
+		dst.get_data_for_clone_into() = static_cast<const T&>( carrier_.data_ );
 	}
 
 	/**
 	 * @brief check this is locked or not
 	 *
+	 * The answer may be stale when this returns. To acquire the lock without blocking, use try_lock_get().
+	 *
 	 * @return true
 	 * @return false
 	 */
 	bool is_locked( void ) const
 	{
-		bool ans = sp_data_->mtx_.try_lock();
+		bool ans = carrier_.mtx_.try_lock();
 		if ( ans ) {
-			sp_data_->mtx_.unlock();
+			carrier_.mtx_.unlock();
 		}
 		return !ans;
 	}
 
-private:
-	obj_mutex( const std::shared_ptr<data_carrier_base_mtx<MTX_T>>& sp_data_arg )
-	  : sp_data_( sp_data_arg )
+	/**
+	 * @brief get the statistics of the mutex
+	 *
+	 * This is available if MTX_T provides stats(), e.g. obj_instrumented_mutex.
+	 *
+	 * @return the return value of MTX_T::stats()
+	 */
+	template <typename MTX_U = MTX_T>
+	auto stats( void ) const -> decltype( std::declval<const MTX_U&>().stats() )
 	{
+		return carrier_.mtx_.stats();
 	}
 
-	// コピーコンストラクタを定義した場合、文脈上、2つの振る舞いが利用者の期待値として存在しうる。
-	// (1)保持している型Tの実体のコピー=複製。いわゆる深いコピー。
-	//    既存のインスタントと異なるオブジェクトが生成される＝排他制御は分離される。
-	// (2)排他制御を行うためのアクセスポイントとしての複製。いわゆる浅いコピー。
-	//
-	// obj_mutexの趣旨として、データ実体はアクセスは、single_accessor経由でアクセスすべきである。
-	// この点を踏まえると、(1)を実装すべきと考えられるが、一方でコードの見た目として(2)のと区別が不明である。
-	// よって、コピーコンストラクタ、copy assignmentは定義しない。
-	// (1)相当の機能は、clone()で提供する。
-	// (2)相当の機能は、shared_clone()で提供する。
+	/**
+	 * @brief wake up one of the accessors that wait by single_accessor::wait()
+	 *
+	 * This is available if MTX_T has the condition variable, e.g. obj_condition_mutex.
+	 */
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_condition_waitable<MTX_U>::value>::type* = nullptr>
+	void notify_one( void ) const
+	{
+		carrier_.mtx_.notify_one();
+	}
+
+	/**
+	 * @brief wake up all of the accessors that wait by single_accessor::wait()
+	 *
+	 * This is available if MTX_T has the condition variable, e.g. obj_condition_mutex.
+	 */
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_condition_waitable<MTX_U>::value>::type* = nullptr>
+	void notify_all( void ) const
+	{
+		carrier_.mtx_.notify_all();
+	}
+
+	/**
+	 * @brief modify a target object by f, and publish it to optimistic_read() without the data race
+	 *
+	 * This is available if T is trivially copyable and MTX_T has the sequence counter, e.g. obj_seqlock_mutex.
+	 * f modifies a copy under the lock, and the copy is stored back by the relaxed atomic stores.
+	 * Writes through lock_get() or with_lock() are plain stores, so they race with optimistic_read() in the sense of the memory model.
+	 * Use this when optimistic_read() may run at the same time.
+	 *
+	 * @tparam F type of callable object that is callable as f(T&)
+	 * @param f callable object
+	 */
+	template <typename F, typename U = T, typename MTX_U = MTX_T,
+	          typename std::enable_if<std::is_trivially_copyable<U>::value && obj_mutex_impl::is_seq_lockable<MTX_U>::value>::type* = nullptr>
+	void publish( F&& f )
+	{
+		std::lock_guard<MTX_T> lk( carrier_.mtx_ );
+
+		T tmp( carrier_.data_ );   // lockの保持者だけが書き込むため、通常のコピーでよい。
+		f( tmp );
+		obj_mutex_impl::seqlock_write( carrier_.data_, tmp );
+	}
+
+	/**
+	 * @brief get a copy of a target object without locking
+	 *
+	 * This is available if T is trivially copyable and MTX_T has the sequence counter, e.g. obj_seqlock_mutex.
+	 *
+	 * @return a copy of a target object
+	 */
+	template <typename U = T, typename MTX_U = MTX_T,
+	          typename std::enable_if<std::is_trivially_copyable<U>::value && obj_mutex_impl::is_seq_lockable<MTX_U>::value>::type* = nullptr>
+	typename std::remove_cv<T>::type optimistic_read( void ) const
+	{
+		return obj_mutex_impl::seqlock_read<typename std::remove_cv<T>::type>( carrier_.mtx_, carrier_.data_ );
+	}
+
+	/**
+	 * @brief load the value of std::atomic without the mutex
+	 *
+	 * This is available if T is std::atomic of a non-class type that is lock-free, e.g. obj_mutex<std::atomic<int>>.
+	 * lock_get() is also available, and the accessor provides std::atomic<X>&. Therefore the lock-free operations and the accessors do not race.
+	 *
+	 * @param order memory order
+	 * @return the value
+	 */
+	template <typename U = T, typename std::enable_if<obj_mutex_impl::is_lock_free_atomic<U>::value>::type* = nullptr>
+	typename obj_mutex_impl::is_lock_free_atomic<U>::value_type load( std::memory_order order = std::memory_order_seq_cst ) const
+	{
+		return carrier_.data_.load( order );
+	}
+
+	/**
+	 * @brief update the value of std::atomic by f without the mutex
+	 *
+	 * This is the CAS loop, so f may be called more than once and should not have side effects.
+	 *
+	 * @tparam F type of callable object that is callable as f(X) and returns X
+	 * @param f callable object that returns a new value from the old value
+	 * @param order memory order of the successful update
+	 * @return the old value
+	 */
+	template <typename F, typename U = T, typename std::enable_if<obj_mutex_impl::is_lock_free_atomic<U>::value>::type* = nullptr>
+	typename obj_mutex_impl::is_lock_free_atomic<U>::value_type fetch_update( F f, std::memory_order order = std::memory_order_seq_cst )
+	{
+		return obj_mutex_impl::atomic_fetch_update( carrier_.data_, f, order );
+	}
+
+private:
+	using carrier_t = typename obj_mutex_impl::storage_traits<inline_storage, MTX_T>::template carrier_t<T>;
+
 	obj_mutex( const obj_mutex& orig )            = delete;
 	obj_mutex& operator=( const obj_mutex& orig ) = delete;
 
-	template <typename U, typename X = T, typename std::enable_if<std::is_class<X>::value>::type* = nullptr>
-	U& get_ref( void )
+	MTX_T& get_mtx_for_lock_all( void ) const
 	{
-		return dynamic_cast<U&>( *sp_data_ );
+		return carrier_.mtx_;
 	}
 
-	template <typename U, typename X = T, typename std::enable_if<std::is_class<X>::value>::type* = nullptr>
-	const U& get_ref( void ) const
+	single_accessor adopt_lock_get( bool owns_lock )
 	{
-		return dynamic_cast<U&>( *sp_data_ );
+		std::unique_lock<MTX_T> lk_my;
+		if ( owns_lock ) {
+			lk_my = std::unique_lock<MTX_T>( carrier_.mtx_, std::adopt_lock );
+		}
+		return single_accessor( std::move( lk_my ), &carrier_, carrier_.data_ );
 	}
 
-	template <typename U, typename X = T, typename std::enable_if<!std::is_class<X>::value>::type* = nullptr>
-	U& get_ref( void )
+	T& get_data_for_clone_into( void )
 	{
-		auto sp_tt = std::dynamic_pointer_cast<data_carrier_non_class<T, MTX_T>>( sp_data_ );
-		if ( sp_tt == nullptr ) {
-			throw std::bad_cast();
-			// 自身が保持しているクラス型ではない型Tへのキャストなので、dynamic_castは必ず成功する。
-			// そのため、この例外を発生させるテストコードは書けない。
-			// なお、sp_data_自身は、get_refを呼び出す側で、non nullptrであることが確認済みとなっている前提。
-		}
-		return sp_tt->data_;
+		return carrier_.data_;
 	}
 
-	template <typename U, typename X = T, typename std::enable_if<!std::is_class<X>::value>::type* = nullptr>
-	const U& get_ref( void ) const
+	mutable carrier_t carrier_;   // const なlock_get()でもmutexをlockするため、mutableとする。
+
+	template <typename U, typename MTX_U, typename STORAGE_U>
+	friend class obj_mutex;
+	friend struct obj_mutex_impl::lock_all_helper;
+};
+
+#if __cplusplus >= 201402L
+namespace obj_mutex_impl {
+
+/**
+ * @brief implementation of lock_get_all()
+ *
+ * The mutexes are locked in the order of the address. Therefore lock_get_all() does not deadlock with other lock_get_all().
+ * If all mutexes have the rank, e.g. obj_ranked_mutex, they are locked in the order of the rank, and in the order of the address in the same rank.
+ * If some obj_mutex share the same carrier by shared_clone(), its mutex is locked only once.
+ */
+struct lock_all_helper {
+	struct lock_entry {
+		void*        p_mtx_;
+		void ( *p_lock_ )( void* );
+		void ( *p_unlock_ )( void* );
+		bool         is_ranked_;
+		unsigned int rank_;
+	};
+
+	template <typename MTX_T>
+	static void lock_mtx( void* p_mtx )
 	{
-		auto sp_tt = std::dynamic_pointer_cast<data_carrier_non_class<T, MTX_T>>( sp_data_ );
-		if ( sp_tt == nullptr ) {
-			throw std::bad_cast();
-			// 自身が保持しているクラス型ではない型Tへのキャストなので、dynamic_castは必ず成功する。
-			// そのため、この例外を発生させるテストコードは書けない。
-			// なお、sp_data_自身は、get_refを呼び出す側で、non nullptrであることが確認済みとなっている前提。
+		static_cast<MTX_T*>( p_mtx )->lock();
+	}
+	template <typename MTX_T>
+	static void unlock_mtx( void* p_mtx )
+	{
+		static_cast<MTX_T*>( p_mtx )->unlock();
+	}
+
+	template <typename MTX_T>
+	static lock_entry make_entry( MTX_T& mtx )
+	{
+		return lock_entry { static_cast<void*>( &mtx ), &lock_mtx<MTX_T>, &unlock_mtx<MTX_T>, lock_rank_of<MTX_T>::is_ranked, lock_rank_of<MTX_T>::value };
+	}
+
+	static bool is_before( const lock_entry& a, const lock_entry& b, bool is_by_rank )
+	{
+		if ( is_by_rank && ( a.rank_ != b.rank_ ) ) {
+			return a.rank_ < b.rank_;
 		}
-		return sp_tt->data_;
+		return std::less<void*>()( a.p_mtx_, b.p_mtx_ );
 	}
 
-	std::shared_ptr<data_carrier_base_mtx<MTX_T>> sp_data_;
+	template <typename... OBJs, std::size_t... Is>
+	static std::tuple<typename OBJs::single_accessor...> lock_get_all( std::index_sequence<Is...>, OBJs&... objs )
+	{
+		constexpr std::size_t N = sizeof...( OBJs );
 
-	template <typename U, typename MTX_U>
-	friend class obj_mutex;
+		lock_entry entries[N] = { make_entry( objs.get_mtx_for_lock_all() )... };
+
+		// 同じcarrierを共有するobj_mutexのうち、先頭のものだけがlockを所有する。
+		bool owns_lock[N];
+		for ( std::size_t i = 0; i < N; i++ ) {
+			owns_lock[i] = true;
+			for ( std::size_t j = 0; j < i; j++ ) {
+				if ( entries[j].p_mtx_ == entries[i].p_mtx_ ) {
+					owns_lock[i] = false;
+					break;
+				}
+			}
+		}
+
+		lock_entry sorted[N];
+		std::size_t n_sorted = 0;
+		for ( std::size_t i = 0; i < N; i++ ) {
+			if ( owns_lock[i] ) {
+				sorted[n_sorted] = entries[i];
+				n_sorted++;
+			}
+		}
+		// すべてのmutexがrankを持つ場合は、rankの検査に違反しないようにrank順、同じrankの中はアドレス順とする。
+		// rankを持たないmutexを含む場合は、アドレス順とする。
+		bool is_by_rank = true;
+		for ( std::size_t i = 0; i < n_sorted; i++ ) {
+			is_by_rank = is_by_rank && sorted[i].is_ranked_;
+		}
+
+		// Nは引数の数であり小さいため、挿入ソートで並べる。
+		for ( std::size_t i = 1; i < n_sorted; i++ ) {
+			lock_entry  e = sorted[i];
+			std::size_t j = i;
+			for ( ; j > 0 && is_before( e, sorted[j - 1], is_by_rank ); j-- ) {
+				sorted[j] = sorted[j - 1];
+			}
+			sorted[j] = e;
+		}
+
+		std::size_t n_locked = 0;
+		try {
+			for ( ; n_locked < n_sorted; n_locked++ ) {
+				OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquire, sorted[n_locked].p_mtx_ );
+				sorted[n_locked].p_lock_( sorted[n_locked].p_mtx_ );
+				OBJECT_MUTEX_TRACE_HOOK( obj_trace_event::acquired, sorted[n_locked].p_mtx_ );
+			}
+		} catch ( ... ) {
+			while ( n_locked > 0 ) {
+				n_locked--;
+				sorted[n_locked].p_unlock_( sorted[n_locked].p_mtx_ );
+			}
+			throw;
+		}
+
+		return std::tuple<typename OBJs::single_accessor...>( objs.adopt_lock_get( owns_lock[Is] )... );
+	}
 };
 
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief lock all obj_mutex objects without deadlock, and get single accessors of them
+ *
+ * The mutexes are locked in the order of the address of the mutex, so lock_get_all() with the same objects in a different order does not deadlock.
+ * If all mutexes have the rank, e.g. obj_ranked_mutex, they are locked in the order of the rank, so that the lock order check accepts them.
+ * If some of objs share the same mutex by shared_clone(), the mutex is locked only once.
+ * In that case, the first accessor of them owns the lock, and the others are valid while the first one is alive.
+ *
+ * if some of objs is not valid( valid() is flase ), this throws std::logic_error before locking any mutex.
+ *
+ * @param objs obj_mutex objects to lock
+ * @return std::tuple of single_accessor that is same order to objs
+ */
+template <typename... Ts, typename... MTXs, typename... STORAGEs>
+std::tuple<typename obj_mutex<Ts, MTXs, STORAGEs>::single_accessor...> lock_get_all( obj_mutex<Ts, MTXs, STORAGEs>&... objs )
+{
+	static_assert( sizeof...( Ts ) > 0, "lock_get_all() needs one or more obj_mutex" );
+	return obj_mutex_impl::lock_all_helper::lock_get_all( std::index_sequence_for<Ts...>(), objs... );
+}
+#endif
+
 #endif
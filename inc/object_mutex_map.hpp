@@ -0,0 +1,228 @@
+/**
+ * @file object_mutex_map.hpp
+ * @author PFA03027@nifty.com
+ * @brief hash map that stripes the entries across the shards of obj_mutex
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_MUTEX_MAP_HPP_
+#define OBJECT_MUTEX_MAP_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "object_mutex.hpp"
+
+/**
+ * @brief hash map that stripes the entries across SHARDS shards. Each shard is std::unordered_map that is protected by obj_mutex.
+ *
+ * The accesses to the keys in the different shards do not contend.
+ * lock_get(key) returns single_accessor of V that holds the lock of the shard, so the other keys in the same shard are also locked while the accessor is alive.
+ * Therefore a thread that has an accessor should not get another accessor of the same map, it may deadlock.
+ *
+ * Each shard is aligned to the cache line by cacheline_aligned if it is available, so the neighboring shards do not cause false sharing.
+ *
+ * @tparam K type of key
+ * @tparam V type of value
+ * @tparam SHARDS number of shards
+ * @tparam MTX_T type of mutex of each shard
+ * @tparam HASH hash function of K
+ * @tparam KEY_EQ equality function of K
+ */
+template <typename K, typename V, std::size_t SHARDS = 16, typename MTX_T = std::mutex, typename HASH = std::hash<K>, typename KEY_EQ = std::equal_to<K>>
+class obj_mutex_map {
+	static_assert( SHARDS > 0, "SHARDS should be larger than 0" );
+
+public:
+	using shard_map_t = std::unordered_map<K, V, HASH, KEY_EQ>;
+#if defined( __cpp_aligned_new )
+	using shard_storage_t = cacheline_aligned;
+#else
+	using shard_storage_t = shared_storage;
+#endif
+	using single_accessor = obj_mutex_impl::single_accessor<V, MTX_T, shard_storage_t>;
+
+	obj_mutex_map( void )
+	  : hasher_()
+	  , shards_()
+	{
+	}
+
+	/**
+	 * @brief get single accessor of the value of key
+	 *
+	 * @exception std::out_of_range key is not found
+	 */
+	single_accessor lock_get( const K& key )
+	{
+		auto acc = get_shard( key ).lock_get();
+		auto it  = acc.ref().find( key );
+		if ( it == acc.ref().end() ) {
+			throw std::out_of_range( "obj_mutex_map does not have the key" );
+		}
+		return obj_mutex_impl::accessor_projector::project( std::move( acc ), it->second );
+	}
+
+	/**
+	 * @brief get single accessor of the value of key if the key exists
+	 *
+	 * @return single_accessor if key is not found, the accessor is empty( valid() is false ).
+	 */
+	single_accessor find( const K& key )
+	{
+		auto acc = get_shard( key ).lock_get();
+		auto it  = acc.ref().find( key );
+		if ( it == acc.ref().end() ) {
+			return obj_mutex_impl::accessor_projector::make_empty<V, MTX_T, shard_storage_t>();
+		}
+		return obj_mutex_impl::accessor_projector::project( std::move( acc ), it->second );
+	}
+
+	/**
+	 * @brief insert V(args...) if key does not exist, and get single accessor of the value of key
+	 *
+	 * The semantics is same to std::unordered_map::try_emplace(). If key exists, args are not moved.
+	 *
+	 * @return std::pair<single_accessor, bool> bool is true if the value is inserted.
+	 */
+	template <typename... Args>
+	std::pair<single_accessor, bool> try_emplace( const K& key, Args&&... args )
+	{
+		auto acc = get_shard( key ).lock_get();
+		auto it  = acc.ref().find( key );
+		if ( it != acc.ref().end() ) {
+			return std::pair<single_accessor, bool>( obj_mutex_impl::accessor_projector::project( std::move( acc ), it->second ), false );
+		}
+		auto ret = acc.ref().emplace( std::piecewise_construct, std::forward_as_tuple( key ), std::forward_as_tuple( std::forward<Args>( args )... ) );
+		return std::pair<single_accessor, bool>( obj_mutex_impl::accessor_projector::project( std::move( acc ), ret.first->second ), true );
+	}
+	template <typename... Args>
+	std::pair<single_accessor, bool> try_emplace( K&& key, Args&&... args )
+	{
+		auto acc = get_shard( key ).lock_get();
+		auto it  = acc.ref().find( key );
+		if ( it != acc.ref().end() ) {
+			return std::pair<single_accessor, bool>( obj_mutex_impl::accessor_projector::project( std::move( acc ), it->second ), false );
+		}
+		auto ret = acc.ref().emplace( std::piecewise_construct, std::forward_as_tuple( std::move( key ) ), std::forward_as_tuple( std::forward<Args>( args )... ) );
+		return std::pair<single_accessor, bool>( obj_mutex_impl::accessor_projector::project( std::move( acc ), ret.first->second ), true );
+	}
+
+	/**
+	 * @brief erase the value of key
+	 *
+	 * @return std::size_t number of erased values. 0 or 1.
+	 */
+	std::size_t erase( const K& key )
+	{
+		return get_shard( key ).with_lock( [&key]( shard_map_t& m ) { return m.erase( key ); } );
+	}
+
+	/**
+	 * @brief get the number of values
+	 *
+	 * Each shard is locked one by one, so the answer is not a snapshot of the whole map while other threads are modifying.
+	 */
+	std::size_t size( void ) const
+	{
+		std::size_t ans = 0;
+		for ( const auto& shard : shards_ ) {
+			ans += shard.with_lock( []( const shard_map_t& m ) { return m.size(); } );
+		}
+		return ans;
+	}
+
+	/**
+	 * @brief call f for each shard under the lock of the shard
+	 *
+	 * If num_threads is larger than 1, the shards are processed by num_threads threads in parallel,
+	 * and f is called from the different threads at the same time for the different shards.
+	 * If f throws an exception, the first exception is rethrown after all threads finish.
+	 *
+	 * @tparam F type of callable object that is callable as f(shard_map_t&)
+	 * @param f callable object
+	 * @param num_threads number of threads. 0 means std::thread::hardware_concurrency().
+	 */
+	template <typename F>
+	void for_each_shard( F&& f, unsigned int num_threads = 1 )
+	{
+		if ( num_threads == 0 ) {
+			num_threads = std::max( 1U, std::thread::hardware_concurrency() );
+		}
+		num_threads = static_cast<unsigned int>( std::min<std::size_t>( num_threads, SHARDS ) );
+		if ( num_threads == 1 ) {
+			for ( auto& shard : shards_ ) {
+				shard.with_lock( f );
+			}
+			return;
+		}
+
+		std::atomic<std::size_t> next_idx( 0 );
+		std::exception_ptr       p_first_exception;
+		std::mutex               exception_mtx;
+		auto                     worker = [this, &f, &next_idx, &p_first_exception, &exception_mtx]() {
+			try {
+				for ( std::size_t i = next_idx++; i < SHARDS; i = next_idx++ ) {
+					shards_[i].with_lock( f );
+				}
+			} catch ( ... ) {
+				std::lock_guard<std::mutex> lk( exception_mtx );
+				if ( p_first_exception == nullptr ) {
+					p_first_exception = std::current_exception();
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve( num_threads - 1 );
+		for ( unsigned int i = 1; i < num_threads; i++ ) {
+			threads.emplace_back( worker );
+		}
+		worker();
+		for ( auto& t : threads ) {
+			t.join();
+		}
+		if ( p_first_exception != nullptr ) {
+			std::rethrow_exception( p_first_exception );
+		}
+	}
+
+private:
+	obj_mutex_map( const obj_mutex_map& )            = delete;
+	obj_mutex_map& operator=( const obj_mutex_map& ) = delete;
+
+	using shard_t = obj_mutex<shard_map_t, MTX_T, shard_storage_t>;
+
+	std::size_t shard_index( const K& key ) const
+	{
+		// std::hash of the integer is identity in many implementations. Mix the bits before modulo.
+		std::uint64_t h = static_cast<std::uint64_t>( hasher_( key ) ) * 0x9E3779B97F4A7C15ULL;
+		return static_cast<std::size_t>( ( h >> 32 ) % SHARDS );
+	}
+
+	shard_t& get_shard( const K& key )
+	{
+		return shards_[shard_index( key )];
+	}
+
+	HASH                        hasher_;
+	std::array<shard_t, SHARDS> shards_;
+};
+
+#endif
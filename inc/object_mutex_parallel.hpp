@@ -0,0 +1,180 @@
+/**
+ * @file object_mutex_parallel.hpp
+ * @author PFA03027@nifty.com
+ * @brief parallel for_each over a collection of obj_mutex
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_MUTEX_PARALLEL_HPP_
+#define OBJECT_MUTEX_PARALLEL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_mutex.hpp"
+
+/**
+ * @brief policy of obj_mutex_parallel_for_each()
+ */
+struct obj_parallel_policy {
+	std::size_t num_threads  = 0;    //!< number of the threads including the caller thread. 0 means std::thread::hardware_concurrency().
+	std::size_t chunk_size   = 16;   //!< number of the elements that a thread takes at once
+	std::size_t max_revisits = 16;   //!< number of rounds to revisit the locked elements by try_lock. After that, the element is locked by lock_get().
+};
+
+namespace obj_mutex_impl {
+
+template <typename ELEM_T, typename F>
+class parallel_for_each_worker {
+public:
+	parallel_for_each_worker( const std::vector<ELEM_T*>& elems, F& f, const obj_parallel_policy& policy )
+	  : elems_( elems )
+	  , f_( f )
+	  , policy_( policy )
+	  , next_( 0 )
+	  , exception_mtx_()
+	  , p_exception_()
+	  , is_aborted_( false )
+	{
+	}
+
+	void run( void )
+	{
+		try {
+			std::vector<ELEM_T*> skipped;
+			const std::size_t    num = elems_.size();
+			while ( !is_aborted_.load( std::memory_order_relaxed ) ) {
+				const std::size_t begin = next_.fetch_add( policy_.chunk_size, std::memory_order_relaxed );
+				if ( begin >= num ) {
+					break;
+				}
+				const std::size_t end = std::min( begin + policy_.chunk_size, num );
+				for ( std::size_t i = begin; i < end; i++ ) {
+					if ( !try_visit( *elems_[i] ) ) {
+						skipped.push_back( elems_[i] );   // 他のスレッドが使用中の要素は、workerを待たせずに後回しにする。
+					}
+				}
+			}
+			revisit( skipped );
+		} catch ( ... ) {
+			std::lock_guard<std::mutex> lk( exception_mtx_ );
+			if ( !p_exception_ ) {
+				p_exception_ = std::current_exception();
+			}
+			is_aborted_.store( true, std::memory_order_relaxed );
+		}
+	}
+
+	void rethrow_if_failed( void )
+	{
+		if ( p_exception_ ) {
+			std::rethrow_exception( p_exception_ );
+		}
+	}
+
+private:
+	bool try_visit( ELEM_T& elem )
+	{
+		auto acc = elem.try_lock_get();
+		if ( !acc.valid() ) {
+			return false;
+		}
+		f_( acc.ref() );
+		return true;
+	}
+
+	void revisit( std::vector<ELEM_T*>& skipped )
+	{
+		for ( std::size_t round = 0; !skipped.empty() && round < policy_.max_revisits; round++ ) {
+			std::this_thread::yield();
+			auto it_end = std::remove_if( skipped.begin(), skipped.end(), [this]( ELEM_T* p ) {
+				return !is_aborted_.load( std::memory_order_relaxed ) && try_visit( *p );
+			} );
+			skipped.erase( it_end, skipped.end() );
+			if ( is_aborted_.load( std::memory_order_relaxed ) ) {
+				return;
+			}
+		}
+		for ( ELEM_T* p : skipped ) {
+			if ( is_aborted_.load( std::memory_order_relaxed ) ) {
+				return;
+			}
+			f_( p->lock_get().ref() );
+		}
+	}
+
+	const std::vector<ELEM_T*>& elems_;
+	F&                          f_;
+	const obj_parallel_policy&  policy_;
+	std::atomic<std::size_t>    next_;
+	std::mutex                  exception_mtx_;
+	std::exception_ptr          p_exception_;
+	std::atomic<bool>           is_aborted_;
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief call f for the object of each obj_mutex in range by some threads
+ *
+ * The elements are distributed to the threads by chunks of policy.chunk_size. A thread that finishes its chunk takes the next chunk,
+ * therefore the threads are balanced even if the cost of f varies.
+ * Each element is locked by try_lock_get(). If the element is locked by other thread, e.g. by a request thread,
+ * the element is skipped and is revisited after the other elements, so that the worker does not block.
+ * After policy.max_revisits rounds, the remaining elements are locked by lock_get().
+ *
+ * f is called once for each element, with the lock of the element. f is called by some threads at the same time.
+ * If f throws an exception, the other threads stop to take new elements, and the first exception is rethrown by this function after all threads finish.
+ *
+ * @tparam RANGE type of range of obj_mutex, e.g. std::vector<obj_mutex<Session>>
+ * @tparam F type of callable object that is callable as f(T&)
+ * @param range range of obj_mutex
+ * @param f callable object
+ * @param policy policy of the parallel execution
+ */
+template <typename RANGE, typename F>
+void obj_mutex_parallel_for_each( RANGE& range, F f, const obj_parallel_policy& policy = obj_parallel_policy() )
+{
+	using elem_t = typename std::remove_reference<decltype( *std::begin( range ) )>::type;
+
+	std::vector<elem_t*> elems;
+	for ( auto it = std::begin( range ); it != std::end( range ); ++it ) {
+		elems.push_back( &*it );
+	}
+
+	obj_parallel_policy p = policy;
+	if ( p.chunk_size == 0 ) {
+		p.chunk_size = 1;
+	}
+	std::size_t num_threads = ( p.num_threads == 0 ) ? std::thread::hardware_concurrency() : p.num_threads;
+	num_threads             = std::max<std::size_t>( 1, std::min( num_threads, ( elems.size() + p.chunk_size - 1 ) / p.chunk_size ) );
+
+	obj_mutex_impl::parallel_for_each_worker<elem_t, F> worker( elems, f, p );
+	std::vector<std::thread>                            threads;
+	threads.reserve( num_threads - 1 );   // 生成済みのスレッドがある状態で、vectorの拡張が例外を投げないようにする。
+	for ( std::size_t i = 1; i < num_threads; i++ ) {
+		try {
+			threads.emplace_back( [&worker]() { worker.run(); } );
+		} catch ( ... ) {
+			break;   // スレッドを生成できない場合(std::system_error, std::bad_alloc)は、生成済みのスレッドのみで処理する。
+		}
+	}
+	worker.run();   // 呼び出し元のスレッドも処理に参加する。
+	for ( auto& t : threads ) {
+		t.join();
+	}
+	worker.rethrow_if_failed();
+}
+
+#endif
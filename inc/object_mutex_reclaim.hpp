@@ -0,0 +1,262 @@
+/**
+ * @file object_mutex_reclaim.hpp
+ * @author PFA03027@nifty.com
+ * @brief storage policy that defers the destruction of the carrier to obj_mutex_reclaim()
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_MUTEX_RECLAIM_HPP_
+#define OBJECT_MUTEX_RECLAIM_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "object_mutex.hpp"
+
+/**
+ * @brief storage policy that the carrier is retired instead of being destructed when the last reference is released
+ *
+ * The layout and the available operations are same to intrusive_storage.
+ * When the last obj_mutex, shared_clone() or accessor that refers the carrier is released, the carrier is pushed onto the lock-free retire list.
+ * The carrier, i.e. MTX_T and T, is destructed and deallocated by obj_mutex_reclaim() or by obj_mutex_background_reclaimer later.
+ * Therefore the thread that releases the last reference pays only the cost of a CAS.
+ *
+ * The retire list keeps the memory until obj_mutex_reclaim() is called. If nobody calls it, the remaining carriers are reclaimed at the exit of the program.
+ */
+struct deferred_reclaim_storage {};
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief node of the retire list
+ */
+struct retired_carrier_node {
+	retired_carrier_node* p_next_;
+	void ( *p_reclaim_ )( retired_carrier_node* );
+};
+
+/**
+ * @brief global retire list of the carriers of deferred_reclaim_storage
+ *
+ * push() is lock-free. take_all() detaches whole list by one exchange, therefore pop of each node is not needed and there is no ABA problem.
+ */
+class retire_list {
+public:
+	static void push( retired_carrier_node* p_node ) noexcept
+	{
+		std::atomic<retired_carrier_node*>& head = get_head().head_;
+		retired_carrier_node*               p_cur = head.load( std::memory_order_relaxed );
+		do {
+			p_node->p_next_ = p_cur;
+		} while ( !head.compare_exchange_weak( p_cur, p_node, std::memory_order_release, std::memory_order_relaxed ) );
+	}
+
+	static std::size_t reclaim_all( void )
+	{
+		std::size_t ans = 0;
+		// Tのデストラクタが他のcarrierを解放し、retire listに追加する場合があるため、空になるまで繰り返す。
+		for ( retired_carrier_node* p = take_all(); p != nullptr; p = take_all() ) {
+			while ( p != nullptr ) {
+				retired_carrier_node* p_next = p->p_next_;
+				p->p_reclaim_( p );
+				p = p_next;
+				ans++;
+			}
+		}
+		return ans;
+	}
+
+	/**
+	 * @brief construct the list head before the first carrier
+	 *
+	 * The list head is destructed after the obj_mutex that is constructed after this call, e.g. obj_mutex of static storage duration.
+	 */
+	static void init( void ) noexcept
+	{
+		(void)get_head();
+	}
+
+private:
+	struct list_head {
+		list_head( void )
+		  : head_( nullptr )
+		{
+		}
+
+		~list_head()
+		{
+			reclaim_all();
+		}
+
+		std::atomic<retired_carrier_node*> head_;
+	};
+
+	static list_head& get_head( void )
+	{
+		static list_head head;
+		return head;
+	}
+
+	static retired_carrier_node* take_all( void ) noexcept
+	{
+		return get_head().head_.exchange( nullptr, std::memory_order_acquire );
+	}
+};
+
+/**
+ * @brief base of carrier for deferred_reclaim_storage
+ *
+ * p_destroy_ of the intrusive base pushes this onto the retire list, and p_destroy_now_ has the function to delete the actual carrier.
+ */
+template <typename MTX_T = std::mutex>
+struct deferred_data_carrier_base_mtx : public intrusive_data_carrier_base_mtx<MTX_T>, public retired_carrier_node {
+	deferred_data_carrier_base_mtx( void )
+	  : intrusive_data_carrier_base_mtx<MTX_T>()
+	  , retired_carrier_node { nullptr, nullptr }
+	  , p_destroy_now_( nullptr )
+	{
+	}
+
+	void ( *p_destroy_now_ )( intrusive_data_carrier_base_mtx<MTX_T>* );
+};
+
+template <typename MTX_T>
+struct storage_traits<deferred_reclaim_storage, MTX_T> {
+	using carrier_base_t = deferred_data_carrier_base_mtx<MTX_T>;
+	using carrier_ptr_t  = intrusive_carrier_ptr<carrier_base_t>;
+
+	template <typename T>
+	using carrier_t = typename std::conditional<std::is_class<T>::value,
+	                                            data_carrier_class<T, MTX_T, carrier_base_t>,
+	                                            data_carrier_non_class<T, MTX_T, carrier_base_t>>::type;
+
+	template <typename CARRIER_T, typename... Args>
+	static intrusive_carrier_ptr<CARRIER_T> make_carrier( Args&&... args )
+	{
+		// 確保と破棄はintrusive_storageと同じ方法で行い、破棄の関数だけをretire listへの追加に差し替える。
+		intrusive_carrier_ptr<CARRIER_T> sp_ans = intrusive_traits_t::template make_carrier<CARRIER_T>( std::forward<Args>( args )... );
+		set_retire( sp_ans.get() );
+		return sp_ans;
+	}
+
+	template <typename CARRIER_T, typename ALLOC, typename... Args>
+	static intrusive_carrier_ptr<CARRIER_T> allocate_carrier( const ALLOC& alloc, Args&&... args )
+	{
+		intrusive_carrier_ptr<CARRIER_T> sp_ans = intrusive_traits_t::template allocate_carrier<CARRIER_T>( alloc, std::forward<Args>( args )... );
+		set_retire( sp_ans.get() );
+		return sp_ans;
+	}
+
+	template <typename U, typename T>
+	static U* down_cast( carrier_base_t* p_carrier, T* p_data )
+	{
+		return intrusive_traits_t::template down_cast<U>( p_carrier, p_data );
+	}
+
+private:
+	using intrusive_traits_t = storage_traits<intrusive_storage, MTX_T>;
+
+	static void set_retire( carrier_base_t* p_carrier ) noexcept
+	{
+		retire_list::init();
+		p_carrier->p_destroy_now_ = p_carrier->p_destroy_;
+		p_carrier->p_destroy_     = &retire_carrier;
+		p_carrier->p_reclaim_     = &reclaim_carrier;
+	}
+
+	static void retire_carrier( intrusive_data_carrier_base_mtx<MTX_T>* p_carrier ) noexcept
+	{
+		retire_list::push( static_cast<carrier_base_t*>( p_carrier ) );
+	}
+
+	static void reclaim_carrier( retired_carrier_node* p_node )
+	{
+		carrier_base_t* p_carrier = static_cast<carrier_base_t*>( p_node );
+		p_carrier->p_destroy_now_( p_carrier );
+	}
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief destruct and deallocate all carriers of deferred_reclaim_storage that have been retired
+ *
+ * This is able to be called by any thread at any time. The carriers that are retired while this is running may be reclaimed by this or by the next call.
+ *
+ * @return number of the reclaimed carriers
+ */
+inline std::size_t obj_mutex_reclaim( void )
+{
+	return obj_mutex_impl::retire_list::reclaim_all();
+}
+
+/**
+ * @brief background thread that calls obj_mutex_reclaim() periodically
+ *
+ * The thread starts at the construction, and stops at the destruction after the last obj_mutex_reclaim().
+ */
+class obj_mutex_background_reclaimer {
+public:
+	/**
+	 * @brief start the background thread
+	 *
+	 * @param interval interval of obj_mutex_reclaim()
+	 */
+	template <typename Rep, typename Period>
+	explicit obj_mutex_background_reclaimer( const std::chrono::duration<Rep, Period>& interval )
+	  : mtx_()
+	  , cv_()
+	  , is_stopped_( false )
+	  , th_()
+	{
+		const std::chrono::steady_clock::duration interval_d = std::chrono::duration_cast<std::chrono::steady_clock::duration>( interval );
+		th_                                                  = std::thread( [this, interval_d]() { run( interval_d ); } );
+	}
+
+	obj_mutex_background_reclaimer( void )
+	  : obj_mutex_background_reclaimer( std::chrono::milliseconds( 10 ) )
+	{
+	}
+
+	~obj_mutex_background_reclaimer()
+	{
+		{
+			std::lock_guard<std::mutex> lk( mtx_ );
+			is_stopped_ = true;
+		}
+		cv_.notify_one();
+		th_.join();
+	}
+
+private:
+	obj_mutex_background_reclaimer( const obj_mutex_background_reclaimer& )            = delete;
+	obj_mutex_background_reclaimer& operator=( const obj_mutex_background_reclaimer& ) = delete;
+
+	void run( std::chrono::steady_clock::duration interval )
+	{
+		std::unique_lock<std::mutex> lk( mtx_ );
+		while ( !is_stopped_ ) {
+			cv_.wait_for( lk, interval, [this]() { return is_stopped_; } );
+			lk.unlock();
+			obj_mutex_reclaim();
+			lk.lock();
+		}
+	}
+
+	std::mutex              mtx_;
+	std::condition_variable cv_;
+	bool                    is_stopped_;
+	std::thread             th_;
+};
+
+#endif
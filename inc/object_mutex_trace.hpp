@@ -0,0 +1,201 @@
+/**
+ * @file object_mutex_trace.hpp
+ * @author PFA03027@nifty.com
+ * @brief tracing hooks of the lock holders of obj_mutex and the default per-thread ring buffer
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_MUTEX_TRACE_HPP_
+#define OBJECT_MUTEX_TRACE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#ifndef OBJECT_MUTEX_TRACE_BUFFER_SIZE
+#define OBJECT_MUTEX_TRACE_BUFFER_SIZE 1024   //!< number of the records of the ring buffer per thread. This should be a power of 2.
+#endif
+
+/**
+ * @brief event of the tracing hooks
+ */
+enum class obj_trace_event : std::uint8_t {
+	acquire,    //!< lock_get(), try_lock_get*(), lock_get_all() or co_lock_get() is going to lock the mutex
+	acquired,   //!< the mutex has been locked. if try_lock_get*() fails, this is not recorded after acquire
+	release     //!< single_accessor is going to unlock the mutex by the destructor or by the move assignment
+};
+
+/**
+ * @brief record of the default ring buffer
+ */
+struct obj_trace_record {
+	std::int64_t    timestamp_ns;   //!< time of std::chrono::steady_clock in nanoseconds
+	const void*     p_mtx;          //!< address of the mutex. this identifies the shared carrier.
+	obj_trace_event event;          //!< event
+};
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief node of the list of obj_mutex_trace
+ */
+struct trace_buffer_node {
+	trace_buffer_node* p_prev_;
+	trace_buffer_node* p_next_;
+};
+
+/**
+ * @brief ring buffer of the trace records of one thread
+ *
+ * Only the owner thread writes the records. Therefore record() does not need CAS and does not block.
+ * A reader in other thread detects the records that are overwritten while reading by the two counters, as same as seqlock.
+ */
+class trace_ring_buffer : public trace_buffer_node {
+public:
+	static constexpr std::size_t capacity = OBJECT_MUTEX_TRACE_BUFFER_SIZE;
+	static_assert( ( capacity & ( capacity - 1 ) ) == 0, "OBJECT_MUTEX_TRACE_BUFFER_SIZE should be a power of 2" );
+
+	trace_ring_buffer( void )
+	  : trace_buffer_node { nullptr, nullptr }
+	  , thread_id_( std::this_thread::get_id() )
+	  , begin_( 0 )
+	  , committed_( 0 )
+	  , slots_()
+	{
+	}
+
+	void record( obj_trace_event ev, const void* p_mtx ) noexcept
+	{
+		const std::int64_t  ts  = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+		const std::uint64_t idx = committed_.load( std::memory_order_relaxed );
+		slot&               s   = slots_[idx & ( capacity - 1 )];
+
+		begin_.store( idx + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		s.timestamp_ns_.store( ts, std::memory_order_relaxed );
+		s.p_mtx_.store( p_mtx, std::memory_order_relaxed );
+		s.event_.store( static_cast<std::uint8_t>( ev ), std::memory_order_relaxed );
+		committed_.store( idx + 1, std::memory_order_release );
+	}
+
+	template <typename F>
+	void for_each( F& f ) const
+	{
+		const std::uint64_t end   = committed_.load( std::memory_order_acquire );
+		const std::uint64_t first = ( end > capacity ) ? end - capacity : 0;
+
+		obj_trace_record records[capacity];
+		for ( std::uint64_t i = first; i < end; i++ ) {
+			const slot& s                   = slots_[i & ( capacity - 1 )];
+			records[i - first].timestamp_ns = s.timestamp_ns_.load( std::memory_order_relaxed );
+			records[i - first].p_mtx        = s.p_mtx_.load( std::memory_order_relaxed );
+			records[i - first].event        = static_cast<obj_trace_event>( s.event_.load( std::memory_order_relaxed ) );
+		}
+		std::atomic_thread_fence( std::memory_order_acquire );
+
+		// 読み出し中に書き手が上書きした可能性があるrecordを捨てる。
+		const std::uint64_t begin      = begin_.load( std::memory_order_relaxed );
+		const std::uint64_t valid_from = ( begin > capacity ) ? begin - capacity : 0;
+		for ( std::uint64_t i = ( valid_from > first ) ? valid_from : first; i < end; i++ ) {
+			f( thread_id_, records[i - first] );
+		}
+	}
+
+private:
+	trace_ring_buffer( const trace_ring_buffer& )            = delete;
+	trace_ring_buffer& operator=( const trace_ring_buffer& ) = delete;
+
+	struct slot {
+		std::atomic<std::int64_t> timestamp_ns_;
+		std::atomic<const void*>  p_mtx_;
+		std::atomic<std::uint8_t> event_;
+	};
+
+	const std::thread::id      thread_id_;
+	std::atomic<std::uint64_t> begin_;       // 書き込みを開始したrecordの数
+	std::atomic<std::uint64_t> committed_;   // 書き込みを完了したrecordの数
+	slot                       slots_[capacity];
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief global registry of the ring buffers of the alive threads
+ *
+ * The ring buffer of a thread is registered when the thread records the first event, and is unregistered when the thread exits.
+ */
+class obj_mutex_trace {
+public:
+	/**
+	 * @brief record an event into the ring buffer of the current thread
+	 *
+	 * This is the default sink of OBJECT_MUTEX_TRACE_SINK.
+	 */
+	static void record( obj_trace_event ev, const void* p_mtx ) noexcept
+	{
+		static thread_local buffer_holder holder;
+		holder.buf_.record( ev, p_mtx );
+	}
+
+	/**
+	 * @brief call f for each record in the ring buffers of the alive threads
+	 *
+	 * The records are passed in the order of the record per thread. The threads keep recording while dumping, and they are not blocked.
+	 * The registry is locked while calling f. Therefore f should not start or finish any thread that records the events.
+	 *
+	 * @tparam F type of callable object that is callable as f(std::thread::id, const obj_trace_record&)
+	 * @param f callable object
+	 */
+	template <typename F>
+	static void dump( F&& f )
+	{
+		std::lock_guard<std::mutex> lk( get_mtx() );
+		for ( const obj_mutex_impl::trace_buffer_node* p = get_head().p_next_; p != &get_head(); p = p->p_next_ ) {
+			static_cast<const obj_mutex_impl::trace_ring_buffer*>( p )->for_each( f );
+		}
+	}
+
+private:
+	struct buffer_holder {
+		buffer_holder( void )
+		  : buf_()
+		{
+			std::lock_guard<std::mutex> lk( get_mtx() );
+			obj_mutex_impl::trace_buffer_node& head = get_head();
+			buf_.p_prev_                            = head.p_prev_;
+			buf_.p_next_                            = &head;
+			head.p_prev_->p_next_                   = &buf_;
+			head.p_prev_                            = &buf_;
+		}
+
+		~buffer_holder()
+		{
+			std::lock_guard<std::mutex> lk( get_mtx() );
+			buf_.p_prev_->p_next_ = buf_.p_next_;
+			buf_.p_next_->p_prev_ = buf_.p_prev_;
+		}
+
+		obj_mutex_impl::trace_ring_buffer buf_;
+	};
+
+	static std::mutex& get_mtx( void )
+	{
+		static std::mutex mtx;
+		return mtx;
+	}
+
+	static obj_mutex_impl::trace_buffer_node& get_head( void )
+	{
+		static obj_mutex_impl::trace_buffer_node head { &head, &head };
+		return head;
+	}
+};
+
+#endif
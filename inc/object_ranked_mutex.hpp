@@ -0,0 +1,234 @@
+/**
+ * @file object_ranked_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief mutex wrapper that checks the lock order by the rank for obj_mutex
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_RANKED_MUTEX_HPP_
+#define OBJECT_RANKED_MUTEX_HPP_
+
+#include <mutex>
+
+#ifndef OBJECT_MUTEX_LOCK_RANK_CHECK
+#ifdef NDEBUG
+#define OBJECT_MUTEX_LOCK_RANK_CHECK 0
+#else
+#define OBJECT_MUTEX_LOCK_RANK_CHECK 1
+#endif
+#endif
+
+#if OBJECT_MUTEX_LOCK_RANK_CHECK != 0
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "object_mutex.hpp"
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief thread local stack of the ranks of the mutexes that are held by the current thread
+ *
+ * The ranks in the stack are increasing, because a lock with a rank that is not larger than the top is rejected.
+ * The exception is the re-entry of the mutex at the top by recursive MTX_T, e.g. std::recursive_mutex. It is pushed again with the same rank.
+ * The unlock may not be in the reverse order, e.g. the move-assignment of single_accessor unlocks the old one after the new one is locked.
+ * Therefore pop() searches the entry from the top.
+ */
+class lock_rank_stack {
+public:
+	static constexpr std::size_t max_depth = 32;   //!< maximum number of ranked mutexes that a thread holds at the same time
+
+	static lock_rank_stack& get( void )
+	{
+		static thread_local lock_rank_stack st;
+		return st;
+	}
+
+	void check( unsigned int rank, const void* p_mtx ) const
+	{
+		if ( depth_ > 0 && entries_[depth_ - 1].p_mtx_ == p_mtx ) {
+			return;   // 再帰的なMTX_Tによる同じmutexの再獲得は、デッドロックの原因とならない。
+		}
+		if ( depth_ > 0 && entries_[depth_ - 1].rank_ >= rank ) {
+			throw std::logic_error( "lock order violation: lock of rank " + std::to_string( rank ) +
+			                        " while holding rank " + std::to_string( entries_[depth_ - 1].rank_ ) );
+		}
+	}
+
+	void push( unsigned int rank, const void* p_mtx )
+	{
+		if ( depth_ >= max_depth ) {
+			throw std::logic_error( "too many ranked mutexes are held by one thread" );
+		}
+		entries_[depth_] = entry { rank, p_mtx };
+		depth_++;
+	}
+
+	void pop( const void* p_mtx ) noexcept
+	{
+		for ( std::size_t i = depth_; i > 0; i-- ) {
+			if ( entries_[i - 1].p_mtx_ == p_mtx ) {
+				for ( std::size_t j = i; j < depth_; j++ ) {
+					entries_[j - 1] = entries_[j];
+				}
+				depth_--;
+				return;
+			}
+		}
+	}
+
+	std::size_t depth( void ) const noexcept
+	{
+		return depth_;
+	}
+
+private:
+	lock_rank_stack( void )
+	  : entries_()
+	  , depth_( 0 )
+	{
+	}
+
+	struct entry {
+		unsigned int rank_;
+		const void*  p_mtx_;
+	};
+
+	entry       entries_[max_depth];
+	std::size_t depth_;
+};
+
+/**
+ * @brief mutex wrapper that checks the lock order by RANK
+ *
+ * @tparam RANK rank of this mutex
+ * @tparam MTX_T type of the underlying mutex. If MTX_T is SharedLockable, this is also.
+ */
+template <unsigned int RANK, typename MTX_T>
+class checked_ranked_mutex {
+public:
+	static constexpr unsigned int rank = RANK;
+
+	checked_ranked_mutex( void )
+	  : mtx_()
+	{
+	}
+
+	void lock( void )
+	{
+		lock_rank_stack& st = lock_rank_stack::get();
+		st.check( RANK, this );   // デッドロックする前に検出するため、lockより先に確認する。
+		mtx_.lock();
+		push_or_unlock( st, &checked_ranked_mutex::unlock_underlying );
+	}
+
+	bool try_lock( void )
+	{
+		// try_lockは待たないため、デッドロックの原因とならない。順序を確認せずに記録のみ行う。
+		if ( !mtx_.try_lock() ) {
+			return false;
+		}
+		push_or_unlock( lock_rank_stack::get(), &checked_ranked_mutex::unlock_underlying );
+		return true;
+	}
+
+	void unlock( void )
+	{
+		lock_rank_stack::get().pop( this );
+		mtx_.unlock();
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	void lock_shared( void )
+	{
+		lock_rank_stack& st = lock_rank_stack::get();
+		st.check( RANK, this );
+		mtx_.lock_shared();
+		push_or_unlock( st, &checked_ranked_mutex::unlock_shared_underlying );
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	bool try_lock_shared( void )
+	{
+		if ( !mtx_.try_lock_shared() ) {
+			return false;
+		}
+		push_or_unlock( lock_rank_stack::get(), &checked_ranked_mutex::unlock_shared_underlying );
+		return true;
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	void unlock_shared( void )
+	{
+		lock_rank_stack::get().pop( this );
+		mtx_.unlock_shared();
+	}
+
+private:
+	checked_ranked_mutex( const checked_ranked_mutex& )            = delete;
+	checked_ranked_mutex& operator=( const checked_ranked_mutex& ) = delete;
+
+	void unlock_underlying( void )
+	{
+		mtx_.unlock();
+	}
+
+	template <typename MTX_U = MTX_T>
+	void unlock_shared_underlying( void )
+	{
+		mtx_.unlock_shared();
+	}
+
+	void push_or_unlock( lock_rank_stack& st, void ( checked_ranked_mutex::*p_unlock )( void ) )
+	{
+		try {
+			st.push( RANK, this );
+		} catch ( ... ) {
+			( this->*p_unlock )();
+			throw;
+		}
+	}
+
+	MTX_T mtx_;
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief mutex with the rank of the lock order
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<T, obj_ranked_mutex<5>>.
+ * If OBJECT_MUTEX_LOCK_RANK_CHECK is not 0, a thread is able to lock only the mutex whose rank is larger than the ranks of all mutexes that the thread holds.
+ * Otherwise lock() throws std::logic_error before it blocks. Therefore the lock order inversions are detected even if they do not deadlock in the test.
+ * try_lock() is not checked, because it does not wait.
+ *
+ * If OBJECT_MUTEX_LOCK_RANK_CHECK is 0, this is an alias of MTX_T, and there is no cost.
+ * OBJECT_MUTEX_LOCK_RANK_CHECK is 1 by default, and is 0 if NDEBUG is defined.
+ *
+ * Notes:
+ * @li Two different mutexes of the same rank are not able to be locked at the same time by lock(). This includes the move-assignment of single_accessor
+ *     like acc = other.lock_get(), because the new lock is acquired before the old lock is released. Destroy the old accessor before it, or use the different ranks.
+ * @li Re-locking the mutex that the thread has locked last is not reported, because recursive MTX_T, e.g. std::recursive_mutex, allows it.
+ * @li lock_get_all() and clone_into() lock the ranked mutexes in the order of the rank. If the ranks are same, they are reported as same as lock().
+ *
+ * @tparam RANK rank of this mutex
+ * @tparam MTX_T type of the underlying mutex
+ */
+template <unsigned int RANK, typename MTX_T = std::mutex>
+using obj_ranked_mutex = obj_mutex_impl::checked_ranked_mutex<RANK, MTX_T>;
+
+#else
+
+template <unsigned int RANK, typename MTX_T = std::mutex>
+using obj_ranked_mutex = MTX_T;
+
+#endif
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file object_rcu.hpp
+ * @author PFA03027@nifty.com
+ * @brief copy-on-write (RCU style) companion of obj_mutex for read-mostly objects
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_RCU_HPP_
+#define OBJECT_RCU_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "object_mutex.hpp"
+
+/**
+ * @brief A wrapper class that provides the snapshot of T for read-mostly objects
+ *
+ * Readers get the snapshot by snapshot(), and the snapshot is never modified.
+ * Writers make a new T, e.g. by update() that modifies a copy of the current T, and publish it by swapping the pointer.
+ * Readers do not wait for the writers while the writers build the new T. Readers and the writer only contend on the pointer swap.
+ * The old T is released when the last snapshot of it is released.
+ *
+ * Different from obj_mutex, the modification by a writer is not visible through the snapshots that have been taken before.
+ *
+ * @tparam T type of the target object
+ * @tparam MTX_T type of mutex to serialize the writers
+ */
+template <typename T, typename MTX_T = std::mutex>
+class obj_rcu {
+public:
+	/**
+	 * @brief Default constructor of a new obj rcu object
+	 *
+	 * If T has a default constructor, this default constructor is defined.
+	 */
+	template <typename U = T, typename std::enable_if<std::is_default_constructible<U>::value>::type* = nullptr>
+	obj_rcu( void )
+	  : sp_data_( std::make_shared<const T>() )
+	  , writer_mtx_()
+	{
+	}
+
+	/**
+	 * @brief Construct a new obj rcu object
+	 *
+	 * Construct with using T(headarg, args...)
+	 *
+	 * @tparam HEADArg this is a type of 1st argument, and is not type of obj_rcu or obj_mutex
+	 * @tparam Args these are the types of 2nd and more arguments
+	 * @param headarg 1st argument of T's constructor
+	 * @param args 2nd and more arguments of T's constructor
+	 */
+	template <typename HEADArg, typename... Args,
+	          typename std::enable_if<
+				  !std::is_same<
+					  obj_rcu,
+					  typename std::remove_cv<
+						  typename std::remove_reference<HEADArg>::type>::type>::value &&
+				  !obj_mutex_impl::is_obj_mutex<
+					  typename std::remove_cv<
+						  typename std::remove_reference<HEADArg>::type>::type>::value>::type* = nullptr>
+	obj_rcu( HEADArg&& headarg, Args&&... args )
+	  : sp_data_( std::make_shared<const T>( std::forward<HEADArg>( headarg ), std::forward<Args>( args )... ) )
+	  , writer_mtx_()
+	{
+	}
+
+	/**
+	 * @brief Construct a new obj rcu object with a copy of the object of obj_mutex
+	 *
+	 * @tparam U type of the target object of src. T should be constructible from U.
+	 * @param src obj_mutex to copy from. src is locked while copying.
+	 */
+	template <typename U, typename MTX_U, typename STORAGE_U, typename std::enable_if<std::is_constructible<T, const U&>::value>::type* = nullptr>
+	explicit obj_rcu( const obj_mutex<U, MTX_U, STORAGE_U>& src )
+	  : sp_data_( std::make_shared<const T>( src.lock_get().ref() ) )
+	  , writer_mtx_()
+	{
+	}
+
+	/**
+	 * @brief get the snapshot of the current object
+	 *
+	 * The snapshot is not modified by writers. It keeps the object alive while the snapshot is alive.
+	 *
+	 * @tparam U this U is base type of T or same to T
+	 * @return std::shared_ptr<const U> the snapshot
+	 */
+	template <typename U = T, typename std::enable_if<std::is_base_of<U, T>::value || std::is_same<U, T>::value>::type* = nullptr>
+	std::shared_ptr<const U> snapshot( void ) const
+	{
+		return load();
+	}
+
+	/**
+	 * @brief update the object by modifying a copy of the current object
+	 *
+	 * f is called with a copy of the current object, and the modified copy is published after f returns.
+	 * The writers are serialized, so the update by other writer is never lost.
+	 * If f throws an exception, nothing is published.
+	 *
+	 * @tparam F type of callable object that is callable as f(T&)
+	 * @param f callable object
+	 */
+	template <typename F>
+	void update( F&& f )
+	{
+		std::lock_guard<MTX_T> lk( writer_mtx_ );
+		std::shared_ptr<T>     sp_new = std::make_shared<T>( *load() );
+		std::forward<F>( f )( *sp_new );
+		store( std::move( sp_new ) );
+	}
+
+	/**
+	 * @brief replace the object with a new object that is constructed by T(args...)
+	 *
+	 * @tparam Args types of the arguments of T's constructor
+	 * @param args arguments of T's constructor
+	 */
+	template <typename... Args>
+	void emplace( Args&&... args )
+	{
+		std::shared_ptr<const T> sp_new = std::make_shared<const T>( std::forward<Args>( args )... );
+		std::lock_guard<MTX_T>   lk( writer_mtx_ );
+		store( std::move( sp_new ) );
+	}
+
+	/**
+	 * @brief make a obj_mutex that has a copy of the current object
+	 *
+	 * @tparam U type that will clone to
+	 * @tparam MTX_U type of mutex of a cloned object
+	 * @tparam STORAGE_U storage policy of a cloned object
+	 * @return obj_mutex<U, MTX_U, STORAGE_U> a cloned object
+	 */
+	template <typename U = T, typename MTX_U = std::mutex, typename STORAGE_U = shared_storage, typename std::enable_if<std::is_convertible<T, U>::value>::type* = nullptr>
+	obj_mutex<U, MTX_U, STORAGE_U> clone( void ) const
+	{
+		return obj_mutex<U, MTX_U, STORAGE_U>( *load() );
+	}
+
+private:
+	obj_rcu( const obj_rcu& )            = delete;
+	obj_rcu& operator=( const obj_rcu& ) = delete;
+
+#if defined( __cpp_lib_atomic_shared_ptr )
+	std::shared_ptr<const T> load( void ) const
+	{
+		return sp_data_.load( std::memory_order_acquire );
+	}
+
+	void store( std::shared_ptr<const T> sp_new )
+	{
+		sp_data_.store( std::move( sp_new ), std::memory_order_release );
+	}
+
+	std::atomic<std::shared_ptr<const T>> sp_data_;
+#else
+	std::shared_ptr<const T> load( void ) const
+	{
+		return std::atomic_load_explicit( &sp_data_, std::memory_order_acquire );
+	}
+
+	void store( std::shared_ptr<const T> sp_new )
+	{
+		std::atomic_store_explicit( &sp_data_, std::move( sp_new ), std::memory_order_release );
+	}
+
+	std::shared_ptr<const T> sp_data_;   // std::atomic_load/std::atomic_storeでのみアクセスする。
+#endif
+	MTX_T writer_mtx_;
+};
+
+#endif
@@ -0,0 +1,303 @@
+/**
+ * @file object_reader_biased_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief reader-biased reader-writer mutex (BRAVO) for obj_mutex::lock_get_shared()
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_READER_BIASED_MUTEX_HPP_
+#define OBJECT_READER_BIASED_MUTEX_HPP_
+
+#if __cplusplus >= 201402L
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <thread>
+
+#include "object_mutex.hpp"
+
+#ifndef OBJECT_MUTEX_READER_TABLE_SIZE
+#define OBJECT_MUTEX_READER_TABLE_SIZE 4096   //!< number of the slots of the visible readers table. This should be a power of 2.
+#endif
+
+#if defined( __cpp_lib_shared_mutex )
+#define OBJECT_MUTEX_DEFAULT_SHARED_MUTEX std::shared_mutex
+#else
+#define OBJECT_MUTEX_DEFAULT_SHARED_MUTEX std::shared_timed_mutex
+#endif
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief visible readers table that is shared by all obj_reader_biased_mutex
+ *
+ * A reader of the fast path publishes the address of the mutex into the slot that is selected by the hash of the mutex and the thread.
+ * Because the slot is selected by the thread, the readers of the same mutex write the different cache lines in most cases.
+ */
+class visible_readers_table {
+public:
+	static constexpr std::size_t size = OBJECT_MUTEX_READER_TABLE_SIZE;
+	static_assert( ( size & ( size - 1 ) ) == 0, "OBJECT_MUTEX_READER_TABLE_SIZE should be a power of 2" );
+
+	static std::atomic<const void*>* slots( void )
+	{
+		static std::atomic<const void*> table[size] = {};
+		return table;
+	}
+
+	static std::size_t slot_index( const void* p_mtx )
+	{
+		static thread_local const std::size_t th_hash = std::hash<std::thread::id>()( std::this_thread::get_id() );
+
+		std::uint64_t h = static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>( p_mtx ) >> 4 ) ^ static_cast<std::uint64_t>( th_hash );
+		h *= 0x9E3779B97F4A7C15ULL;
+		return static_cast<std::size_t>( h >> 32 ) & ( size - 1 );
+	}
+};
+
+/**
+ * @brief the slots of the fast path that are held by the current thread
+ *
+ * unlock_shared() has no argument. Therefore the slot index of the fast path is kept per thread,
+ * and unlock_shared() uses it to know which path has been taken.
+ */
+class reader_slot_record {
+public:
+	static constexpr std::size_t max_depth = 16;   //!< if the thread holds more, the slow path is used
+
+	static reader_slot_record& get( void )
+	{
+		static thread_local reader_slot_record rec;
+		return rec;
+	}
+
+	bool is_full( void ) const noexcept
+	{
+		return depth_ >= max_depth;
+	}
+
+	void push( const void* p_mtx, std::size_t idx ) noexcept
+	{
+		entries_[depth_] = entry { p_mtx, idx };
+		depth_++;
+	}
+
+	bool pop( const void* p_mtx, std::size_t* p_idx ) noexcept
+	{
+		for ( std::size_t i = depth_; i > 0; i-- ) {
+			if ( entries_[i - 1].p_mtx_ == p_mtx ) {
+				*p_idx = entries_[i - 1].idx_;
+				entries_[i - 1] = entries_[depth_ - 1];
+				depth_--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	reader_slot_record( void )
+	  : entries_()
+	  , depth_( 0 )
+	{
+	}
+
+	struct entry {
+		const void* p_mtx_;
+		std::size_t idx_;
+	};
+
+	entry       entries_[max_depth];
+	std::size_t depth_;
+};
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief reader-biased reader-writer mutex that is based on BRAVO (Biased Locking for Reader-Writer Locks)
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<T, obj_reader_biased_mutex<>>. lock_get_shared() and lock_get() are available as same as SHARED_MTX_T.
+ *
+ * While the reader bias is enabled, lock_shared() does not touch SHARED_MTX_T. It publishes the address of this mutex into the slot of the visible readers table
+ * that is selected by the thread. Therefore the readers do not contend on the reader count of SHARED_MTX_T.
+ * lock() takes the exclusive lock of SHARED_MTX_T, revokes the bias, and waits until the readers of the fast path release their slots.
+ * After the revocation, the readers use SHARED_MTX_T for a while that is proportional to the time of the revocation, and then a reader enables the bias again.
+ *
+ * Guidance:
+ * @li This is suitable for an object that is read by many threads on many cores and is written rarely.
+ * @li lock() scans whole visible readers table when it revokes the bias. If the writes are frequent, use SHARED_MTX_T directly.
+ * @li As same as std::shared_mutex, the shared lock should be released by the thread that has locked it.
+ *
+ * @tparam SHARED_MTX_T type of the underlying reader-writer mutex that is used by the writers and by the readers of the slow path
+ */
+template <typename SHARED_MTX_T = OBJECT_MUTEX_DEFAULT_SHARED_MUTEX>
+class obj_reader_biased_mutex {
+public:
+	static constexpr std::int64_t inhibit_multiplier = 9;   //!< the bias is disabled for this times of the revocation time
+
+	obj_reader_biased_mutex( void )
+	  : rw_mtx_()
+	  , rbias_( true )
+	  , inhibit_until_( 0 )
+	{
+	}
+
+	void lock( void )
+	{
+		rw_mtx_.lock();
+		if ( rbias_.load( std::memory_order_relaxed ) ) {
+			revoke_bias();
+		}
+	}
+
+	bool try_lock( void )
+	{
+		if ( !rw_mtx_.try_lock() ) {
+			return false;
+		}
+		if ( rbias_.load( std::memory_order_relaxed ) ) {
+			// 待ち合わせを行わないため、fast pathの読み手が残っていれば失敗とする。biasは無効化したままとし、次回の試行で成功しやすくする。
+			rbias_.store( false, std::memory_order_seq_cst );
+			inhibit_until_.store( now_ns() + inhibit_multiplier * 1000, std::memory_order_relaxed );
+			if ( has_fast_readers() ) {
+				rw_mtx_.unlock();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void unlock( void )
+	{
+		rw_mtx_.unlock();
+	}
+
+	void lock_shared( void )
+	{
+		if ( try_lock_shared_fast() ) {
+			return;
+		}
+		rw_mtx_.lock_shared();
+		try_enable_bias();
+	}
+
+	bool try_lock_shared( void )
+	{
+		if ( try_lock_shared_fast() ) {
+			return true;
+		}
+		if ( !rw_mtx_.try_lock_shared() ) {
+			return false;
+		}
+		try_enable_bias();
+		return true;
+	}
+
+	void unlock_shared( void )
+	{
+		std::size_t idx;
+		if ( obj_mutex_impl::reader_slot_record::get().pop( this, &idx ) ) {
+			obj_mutex_impl::visible_readers_table::slots()[idx].store( nullptr, std::memory_order_release );
+			return;
+		}
+		rw_mtx_.unlock_shared();
+	}
+
+	/**
+	 * @brief check whether the readers take the fast path now
+	 *
+	 * The answer may be stale when this returns. This is for the monitoring and the tests.
+	 */
+	bool is_reader_biased( void ) const noexcept
+	{
+		return rbias_.load( std::memory_order_relaxed );
+	}
+
+private:
+	obj_reader_biased_mutex( const obj_reader_biased_mutex& )            = delete;
+	obj_reader_biased_mutex& operator=( const obj_reader_biased_mutex& ) = delete;
+
+	static std::int64_t now_ns( void )
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+	}
+
+	bool try_lock_shared_fast( void )
+	{
+		if ( !rbias_.load( std::memory_order_acquire ) ) {
+			return false;
+		}
+		obj_mutex_impl::reader_slot_record& rec = obj_mutex_impl::reader_slot_record::get();
+		if ( rec.is_full() ) {
+			return false;
+		}
+
+		const std::size_t          idx    = obj_mutex_impl::visible_readers_table::slot_index( this );
+		std::atomic<const void*>&  slot   = obj_mutex_impl::visible_readers_table::slots()[idx];
+		const void*                p_null = nullptr;
+		if ( !slot.compare_exchange_strong( p_null, this, std::memory_order_seq_cst ) ) {
+			return false;   // 他のスレッド、または他のmutexとslotが衝突した。
+		}
+		// slotの公開後にbiasを再確認する。書き手はbiasの無効化後にslotを走査する。
+		// 両者のstoreとloadはすべてseq_cstであるため、どちらかが必ず相手を観測する。
+		if ( !rbias_.load( std::memory_order_seq_cst ) ) {
+			slot.store( nullptr, std::memory_order_relaxed );
+			return false;
+		}
+		rec.push( this, idx );
+		return true;
+	}
+
+	void try_enable_bias( void )
+	{
+		// 共有ロックを保持しているため、書き手がクリティカルセクション内にいないことが保証される。
+		if ( !rbias_.load( std::memory_order_relaxed ) && now_ns() >= inhibit_until_.load( std::memory_order_relaxed ) ) {
+			rbias_.store( true, std::memory_order_release );
+		}
+	}
+
+	bool has_fast_readers( void ) const
+	{
+		std::atomic<const void*>* p_slots = obj_mutex_impl::visible_readers_table::slots();
+		for ( std::size_t i = 0; i < obj_mutex_impl::visible_readers_table::size; i++ ) {
+			if ( p_slots[i].load( std::memory_order_seq_cst ) == this ) {   // rbias_のstoreと同じ全順序に入れるため、seq_cstで読む。
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void revoke_bias( void )
+	{
+		const std::int64_t start = now_ns();
+		rbias_.store( false, std::memory_order_seq_cst );
+
+		std::atomic<const void*>* p_slots = obj_mutex_impl::visible_readers_table::slots();
+		for ( std::size_t i = 0; i < obj_mutex_impl::visible_readers_table::size; i++ ) {
+			while ( p_slots[i].load( std::memory_order_seq_cst ) == this ) {   // rbias_のstoreと同じ全順序に入れるため、seq_cstで読む。
+				std::this_thread::yield();
+			}
+		}
+
+		const std::int64_t end = now_ns();
+		inhibit_until_.store( end + ( end - start ) * inhibit_multiplier, std::memory_order_relaxed );
+	}
+
+	SHARED_MTX_T              rw_mtx_;
+	std::atomic<bool>         rbias_;           // trueの間、読み手はvisible readers tableを使用する。
+	std::atomic<std::int64_t> inhibit_until_;   // biasの無効化後、この時刻[ns]まで再有効化しない。
+};
+
+#undef OBJECT_MUTEX_DEFAULT_SHARED_MUTEX
+
+#endif
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file object_seqlock_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief mutex wrapper with the sequence counter for obj_mutex::optimistic_read()
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_SEQLOCK_MUTEX_HPP_
+#define OBJECT_SEQLOCK_MUTEX_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+#include "object_mutex.hpp"
+#include "object_spin_mutex.hpp"
+
+/**
+ * @brief mutex wrapper that has the sequence counter of seqlock
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<Quote, obj_seqlock_mutex<>>.
+ * If T is trivially copyable, obj_mutex::optimistic_read() is available.
+ * optimistic_read() returns a copy of T without locking and without writing any shared cache line,
+ * and it retries when a writer modifies T while copying.
+ *
+ * Writers lock this through lock_get() or with_lock() as usual.
+ * The sequence counter is odd while a writer holds the lock.
+ * Because those writes are plain stores, a writer that runs at the same time as optimistic_read() should use obj_mutex::publish().
+ * publish() and optimistic_read() access T by the relaxed atomic words, so they are free from the data race.
+ *
+ * Guidance:
+ * @li This is suitable for a small T that is read by many threads and is written by a few threads.
+ * @li If writers hold the lock for a long time, readers spin while waiting, and it wastes CPU.
+ * @li MTX_T should not be recursive. If the same thread locks twice, the sequence counter becomes even while the writer holds the lock,
+ *     and optimistic_read() accepts a torn copy. std::recursive_mutex and std::recursive_timed_mutex are rejected at compile time.
+ *
+ * @tparam MTX_T type of the underlying mutex. If MTX_T is SharedLockable, this is also.
+ */
+template <typename MTX_T = std::mutex>
+class obj_seqlock_mutex {
+	static_assert( !std::is_same<MTX_T, std::recursive_mutex>::value && !std::is_same<MTX_T, std::recursive_timed_mutex>::value,
+	               "obj_seqlock_mutex does not support the recursive mutex" );
+
+public:
+	obj_seqlock_mutex( void )
+	  : mtx_()
+	  , seq_( 0 )
+	{
+	}
+
+	void lock( void )
+	{
+		mtx_.lock();
+		begin_write();
+	}
+
+	bool try_lock( void )
+	{
+		if ( !mtx_.try_lock() ) {
+			return false;
+		}
+		begin_write();
+		return true;
+	}
+
+	void unlock( void )
+	{
+		seq_.store( seq_.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+		mtx_.unlock();
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	void lock_shared( void )
+	{
+		mtx_.lock_shared();
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	bool try_lock_shared( void )
+	{
+		return mtx_.try_lock_shared();
+	}
+
+	template <typename MTX_U = MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_U>::value>::type* = nullptr>
+	void unlock_shared( void )
+	{
+		mtx_.unlock_shared();
+	}
+
+	/**
+	 * @brief begin the optimistic read
+	 *
+	 * If a writer holds the lock, this waits until the writer releases it.
+	 *
+	 * @return std::uint32_t the sequence number that should be passed to read_retry()
+	 */
+	std::uint32_t read_begin( void ) const noexcept
+	{
+		std::uint32_t seq = seq_.load( std::memory_order_acquire );
+		while ( ( seq & 1U ) != 0 ) {
+			obj_mutex_impl::cpu_relax();
+			seq = seq_.load( std::memory_order_acquire );
+		}
+		return seq;
+	}
+
+	/**
+	 * @brief check the optimistic read should be retried or not
+	 *
+	 * @param seq the return value of read_begin()
+	 * @return true a writer has modified the object while reading. the read value should be discarded.
+	 * @return false the read value is consistent.
+	 */
+	bool read_retry( std::uint32_t seq ) const noexcept
+	{
+		std::atomic_thread_fence( std::memory_order_acquire );   // 読み出したデータのロードが、シーケンス番号の再読み出しより前に完了するようにする。
+		return seq_.load( std::memory_order_relaxed ) != seq;
+	}
+
+private:
+	obj_seqlock_mutex( const obj_seqlock_mutex& )            = delete;
+	obj_seqlock_mutex& operator=( const obj_seqlock_mutex& ) = delete;
+
+	void begin_write( void )
+	{
+		// lockの保持者だけが更新するため、read-modify-writeは不要。
+		seq_.store( seq_.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );   // 奇数への更新が、データの書き込みより先に見えるようにする。
+	}
+
+	MTX_T                      mtx_;
+	std::atomic<std::uint32_t> seq_;
+};
+
+#endif
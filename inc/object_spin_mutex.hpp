@@ -0,0 +1,209 @@
+/**
+ * @file object_spin_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief adaptive spin lock mutex for obj_mutex
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_SPIN_MUTEX_HPP_
+#define OBJECT_SPIN_MUTEX_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined( __cpp_lib_atomic_wait )
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#include "object_mutex.hpp"
+
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#include <intrin.h>
+#endif
+
+namespace obj_mutex_impl {
+
+/**
+ * @brief hint to the processor that this thread is in a spin loop
+ */
+inline void cpu_relax( void ) noexcept
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+	__builtin_ia32_pause();
+#elif defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+	_mm_pause();
+#elif defined( __aarch64__ ) || defined( __arm__ )
+	asm volatile( "yield" ::: "memory" );
+#else
+#endif
+}
+
+#if !defined( __cpp_lib_atomic_wait )
+/**
+ * @brief bucket of the parking lot that is used by atomic_wait() before C++20
+ */
+struct alignas( OBJECT_MUTEX_CACHE_LINE_SIZE ) park_bucket {
+	std::mutex              mtx_;
+	std::condition_variable cv_;
+};
+
+/**
+ * @brief get the bucket of the parking lot for the address of an atomic variable
+ *
+ * The buckets are shared by all translation units, because this is an inline function.
+ */
+inline park_bucket& get_park_bucket( const void* p_addr ) noexcept
+{
+	static constexpr std::size_t num_buckets = 64;
+	static park_bucket           buckets[num_buckets];
+
+	std::uintptr_t h = reinterpret_cast<std::uintptr_t>( p_addr );
+	h ^= h >> 17;   // 同じキャッシュライン内の変数が同じバケットに集中しないように、上位ビットも混ぜる。
+	return buckets[( h / sizeof( std::uint32_t ) ) % num_buckets];
+}
+#endif
+
+/**
+ * @brief block the calling thread while the value of a is old
+ *
+ * This uses std::atomic::wait() (futex on Linux) in C++20.
+ * Before C++20, the thread parks on std::condition_variable of the parking lot that is selected by the address of a.
+ * This may return spuriously, so the caller should check the value again.
+ * The thread that changes the value should call atomic_notify_one() or atomic_notify_all() after the change.
+ */
+inline void atomic_wait( const std::atomic<std::uint32_t>& a, std::uint32_t old ) noexcept
+{
+#if defined( __cpp_lib_atomic_wait )
+	a.wait( old, std::memory_order_relaxed );
+#else
+	park_bucket&                 b = get_park_bucket( &a );
+	std::unique_lock<std::mutex> lk( b.mtx_ );
+	// 値の変更後に通知側がバケットのmutexを取得するため、ここで古い値を確認してから待てば起床漏れは発生しない。
+	while ( a.load( std::memory_order_relaxed ) == old ) {
+		b.cv_.wait( lk );
+	}
+#endif
+}
+
+/**
+ * @brief wake up at least one thread that waits for a by atomic_wait()
+ */
+inline void atomic_notify_one( std::atomic<std::uint32_t>& a ) noexcept
+{
+#if defined( __cpp_lib_atomic_wait )
+	a.notify_one();
+#else
+	park_bucket& b = get_park_bucket( &a );
+	{
+		std::lock_guard<std::mutex> lk( b.mtx_ );
+	}
+	b.cv_.notify_all();   // バケットは他のアドレスと共有されるため、全員を起こす。
+#endif
+}
+
+/**
+ * @brief wake up all threads that wait for a by atomic_wait()
+ */
+inline void atomic_notify_all( std::atomic<std::uint32_t>& a ) noexcept
+{
+#if defined( __cpp_lib_atomic_wait )
+	a.notify_all();
+#else
+	atomic_notify_one( a );
+#endif
+}
+
+}   // namespace obj_mutex_impl
+
+/**
+ * @brief adaptive spin lock mutex that satisfies the requirements of Lockable
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<T, obj_spin_mutex>.
+ *
+ * lock() tries as below:
+ * 1. test-and-test-and-set with exponential backoff by pause instruction.
+ * 2. if the lock is not acquired after spin_rounds, the thread parks by obj_mutex_impl::atomic_wait().
+ *    That is std::atomic::wait() (futex on Linux) in C++20, or std::condition_variable of a parking lot before C++20.
+ *    A parked thread does not use CPU while the lock is held for a long time.
+ *
+ * Guidance:
+ * @li This beats std::mutex when the critical section is short (a few hundred nanoseconds or less)
+ *     and the number of threads that contend is not larger than the number of cores.
+ *     In that case, the lock is released while spinning, and there is no system call of futex.
+ * @li std::mutex is better when the critical section is long, it may block (I/O, sleep, other locks),
+ *     or the threads are more than the cores. Spinning only wastes CPU in those cases,
+ *     though the fallback to the wait limits the waste.
+ * @li This is not recursive. If the same thread locks twice, it deadlocks. Use std::recursive_mutex for re-entrance.
+ *     std::recursive_mutex is slower than std::mutex, so this is also better than std::recursive_mutex for short critical sections without re-entrance.
+ * @li This is not fair. A waiting thread may starve under heavy contention.
+ */
+class obj_spin_mutex {
+public:
+	static constexpr unsigned int max_backoff = 64;   //!< max number of pause instructions in one backoff
+	static constexpr unsigned int spin_rounds = 16;   //!< number of backoff rounds before falling back to wait
+
+	constexpr obj_spin_mutex( void ) noexcept
+	  : state_( unlocked )
+	{
+	}
+
+	void lock( void ) noexcept
+	{
+		if ( try_lock() ) return;
+		lock_slow();
+	}
+
+	bool try_lock( void ) noexcept
+	{
+		std::uint32_t expected = unlocked;
+		return state_.compare_exchange_strong( expected, locked, std::memory_order_acquire, std::memory_order_relaxed );
+	}
+
+	void unlock( void ) noexcept
+	{
+		if ( state_.exchange( unlocked, std::memory_order_release ) == locked_with_waiter ) {
+			obj_mutex_impl::atomic_notify_one( state_ );
+		}
+	}
+
+private:
+	obj_spin_mutex( const obj_spin_mutex& )            = delete;
+	obj_spin_mutex& operator=( const obj_spin_mutex& ) = delete;
+
+	static constexpr std::uint32_t unlocked           = 0;
+	static constexpr std::uint32_t locked             = 1;
+	static constexpr std::uint32_t locked_with_waiter = 2;   // unlock() should wake up a waiter
+
+	void lock_slow( void ) noexcept
+	{
+		unsigned int backoff = 1;
+		for ( unsigned int round = 0; round < spin_rounds; round++ ) {
+			// test-and-test-and-set: 読み出しだけで待つことで、ロック保持者のキャッシュラインを無効化しない。
+			for ( unsigned int i = 0; i < backoff; i++ ) {
+				obj_mutex_impl::cpu_relax();
+			}
+			if ( state_.load( std::memory_order_relaxed ) == unlocked ) {
+				if ( try_lock() ) return;
+			}
+			if ( backoff < max_backoff ) {
+				backoff <<= 1;
+			}
+		}
+
+		// スピンで獲得できなかったため、待機する。
+		// locked_with_waiterに変更した後は、unlock()が必ずnotifyするため、起床漏れは発生しない。
+		while ( state_.exchange( locked_with_waiter, std::memory_order_acquire ) != unlocked ) {
+			obj_mutex_impl::atomic_wait( state_, locked_with_waiter );
+		}
+	}
+
+	std::atomic<std::uint32_t> state_;
+};
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file object_upgradable_mutex.hpp
+ * @author PFA03027@nifty.com
+ * @brief reader-writer mutex with the upgrade lock for obj_mutex::lock_get_upgradable()
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright (c) 2026, PFA03027@nifty.com
+ *
+ */
+
+#ifndef OBJECT_UPGRADABLE_MUTEX_HPP_
+#define OBJECT_UPGRADABLE_MUTEX_HPP_
+
+#if __cplusplus >= 201402L
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "object_mutex.hpp"
+
+#if defined( __cpp_lib_shared_mutex )
+#define OBJECT_MUTEX_DEFAULT_SHARED_MUTEX std::shared_mutex
+#else
+#define OBJECT_MUTEX_DEFAULT_SHARED_MUTEX std::shared_timed_mutex
+#endif
+
+/**
+ * @brief reader-writer mutex that has the upgrade lock in addition to the exclusive lock and the shared lock
+ *
+ * This can be used as MTX_T of obj_mutex, e.g. obj_mutex<T, obj_upgradable_mutex<>>.
+ * lock_get_shared(), lock_get() and lock_get_upgradable() are available.
+ *
+ * The upgrade lock is a shared lock that excludes the other upgrade locks and the exclusive locks.
+ * It is implemented by the gate mutex that the holders of the upgrade lock and the exclusive lock take before SHARED_MTX_T.
+ * Because only the holder of the gate is able to take the exclusive lock of SHARED_MTX_T,
+ * nobody is able to modify the object b/w unlock_shared() and lock() in unlock_upgrade_and_lock().
+ *
+ * @tparam SHARED_MTX_T type of the underlying reader-writer mutex
+ */
+template <typename SHARED_MTX_T = OBJECT_MUTEX_DEFAULT_SHARED_MUTEX>
+class obj_upgradable_mutex {
+public:
+	obj_upgradable_mutex( void )
+	  : gate_mtx_()
+	  , rw_mtx_()
+	{
+	}
+
+	void lock( void )
+	{
+		std::unique_lock<std::mutex> lk( gate_mtx_ );
+		rw_mtx_.lock();
+		lk.release();
+	}
+
+	bool try_lock( void )
+	{
+		std::unique_lock<std::mutex> lk( gate_mtx_, std::try_to_lock );
+		if ( !lk.owns_lock() || !rw_mtx_.try_lock() ) {
+			return false;
+		}
+		lk.release();
+		return true;
+	}
+
+	void unlock( void )
+	{
+		rw_mtx_.unlock();
+		gate_mtx_.unlock();
+	}
+
+	void lock_shared( void )
+	{
+		rw_mtx_.lock_shared();
+	}
+
+	bool try_lock_shared( void )
+	{
+		return rw_mtx_.try_lock_shared();
+	}
+
+	void unlock_shared( void )
+	{
+		rw_mtx_.unlock_shared();
+	}
+
+	void lock_upgrade( void )
+	{
+		std::unique_lock<std::mutex> lk( gate_mtx_ );
+		rw_mtx_.lock_shared();
+		lk.release();
+	}
+
+	void unlock_upgrade( void )
+	{
+		rw_mtx_.unlock_shared();
+		gate_mtx_.unlock();
+	}
+
+	/**
+	 * @brief atomically change the upgrade lock to the exclusive lock
+	 *
+	 * This blocks until the shared locks are released.
+	 */
+	void unlock_upgrade_and_lock( void )
+	{
+		// gate_mtx_を保持したままであるため、他の書き手がrw_mtx_の排他ロックを取得することはない。
+		rw_mtx_.unlock_shared();
+		rw_mtx_.lock();
+	}
+
+	/**
+	 * @brief atomically change the exclusive lock to the upgrade lock
+	 */
+	void unlock_and_lock_upgrade( void )
+	{
+		rw_mtx_.unlock();
+		rw_mtx_.lock_shared();
+	}
+
+private:
+	obj_upgradable_mutex( const obj_upgradable_mutex& )            = delete;
+	obj_upgradable_mutex& operator=( const obj_upgradable_mutex& ) = delete;
+
+	std::mutex   gate_mtx_;   // upgrade lockと排他ロックの保持者が、rw_mtx_より先に取得する。
+	SHARED_MTX_T rw_mtx_;
+};
+
+#undef OBJECT_MUTEX_DEFAULT_SHARED_MUTEX
+
+#endif
+
+#endif
@@ -0,0 +1,187 @@
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "object_mutex.hpp"
+
+#include "benchmark/benchmark.h"
+
+class bench_base {
+public:
+	bench_base( int a_arg = 0 )
+	  : a( a_arg )
+	{
+	}
+	virtual ~bench_base() = default;
+
+	int a;
+};
+
+class bench_derived : public bench_base {
+public:
+	bench_derived( int a_arg = 0, int b_arg = 0 )
+	  : bench_base( a_arg )
+	  , b( b_arg )
+	{
+	}
+
+	int b;
+};
+
+inline void bench_touch( int& v )
+{
+	v++;
+}
+
+inline void bench_touch( bench_derived& v )
+{
+	v.a++;
+}
+
+template <typename T, typename MTX_T>
+struct raw_mutex_and_data {
+	MTX_T mtx_;
+	T     data_;
+};
+
+// wrapper overhead:
+// BM_raw_mutex is the baseline that locks a raw mutex directly.
+// BM_lock_get does the same thing through obj_mutex::lock_get(), so the difference is the cost of the wrapper and the accessor.
+// CONTENDED == false: each thread has its own object. CONTENDED == true: all threads share one object.
+template <typename T, typename MTX_T, bool CONTENDED>
+static void BM_raw_mutex( benchmark::State& state )
+{
+	static raw_mutex_and_data<T, MTX_T> shared_obj;
+	raw_mutex_and_data<T, MTX_T>        local_obj;
+	raw_mutex_and_data<T, MTX_T>&       obj = CONTENDED ? shared_obj : local_obj;
+	for ( auto _ : state ) {
+		std::lock_guard<MTX_T> lk( obj.mtx_ );
+		bench_touch( obj.data_ );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+
+template <typename T, typename MTX_T, bool CONTENDED>
+static void BM_lock_get( benchmark::State& state )
+{
+	static obj_mutex<T, MTX_T> shared_obj;
+	obj_mutex<T, MTX_T>        local_obj;
+	obj_mutex<T, MTX_T>&       obj = CONTENDED ? shared_obj : local_obj;
+	for ( auto _ : state ) {
+		auto acc = obj.lock_get();
+		bench_touch( acc.ref() );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+
+BENCHMARK_TEMPLATE( BM_raw_mutex, int, std::mutex, false )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_lock_get, int, std::mutex, false )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_raw_mutex, int, std::mutex, true )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_lock_get, int, std::mutex, true )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_raw_mutex, bench_derived, std::mutex, false )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_lock_get, bench_derived, std::mutex, false )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_raw_mutex, bench_derived, std::mutex, true )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_lock_get, bench_derived, std::mutex, true )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_raw_mutex, int, std::recursive_mutex, false )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_lock_get, int, std::recursive_mutex, false )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_raw_mutex, int, std::recursive_mutex, true )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_lock_get, int, std::recursive_mutex, true )->ThreadRange( 1, 64 )->UseRealTime();
+
+// costs of the operations that do not lock or that lock only once
+template <typename T>
+static void BM_clone( benchmark::State& state )
+{
+	obj_mutex<T> obj;
+	for ( auto _ : state ) {
+		obj_mutex<T> cloned = obj.clone();
+		benchmark::DoNotOptimize( cloned );
+	}
+}
+BENCHMARK_TEMPLATE( BM_clone, int );
+BENCHMARK_TEMPLATE( BM_clone, bench_derived );
+
+template <typename T>
+static void BM_shared_clone( benchmark::State& state )
+{
+	obj_mutex<T> obj;
+	for ( auto _ : state ) {
+		obj_mutex<T> cloned = obj.shared_clone();
+		benchmark::DoNotOptimize( cloned );
+	}
+}
+BENCHMARK_TEMPLATE( BM_shared_clone, int );
+BENCHMARK_TEMPLATE( BM_shared_clone, bench_derived );
+
+// move b/w 2 objects back and forth. The difference b/w them is the cost of the down-cast by RTTI.
+static void BM_move_same_type( benchmark::State& state )
+{
+	obj_mutex<bench_derived> obj1;
+	obj_mutex<bench_derived> obj2;
+	for ( auto _ : state ) {
+		obj2 = std::move( obj1 );
+		obj1 = std::move( obj2 );
+	}
+	benchmark::DoNotOptimize( obj1 );
+}
+BENCHMARK( BM_move_same_type );
+
+static void BM_move_up_cast_and_down_cast( benchmark::State& state )
+{
+	obj_mutex<bench_derived> obj_derived;
+	obj_mutex<bench_base>    obj_base;
+	for ( auto _ : state ) {
+		obj_base    = std::move( obj_derived );
+		obj_derived = std::move( obj_base );
+	}
+	benchmark::DoNotOptimize( obj_derived );
+}
+BENCHMARK( BM_move_up_cast_and_down_cast );
+
+static void BM_accessor_move( benchmark::State& state )
+{
+	obj_mutex<int> obj( 0 );
+	auto           acc1 = obj.lock_get();
+	for ( auto _ : state ) {
+		auto acc2 = std::move( acc1 );
+		acc1      = std::move( acc2 );
+	}
+	benchmark::DoNotOptimize( acc1.ref() );
+}
+BENCHMARK( BM_accessor_move );
+
+// striped counter:
+// Each thread increments its own obj_mutex in an array.
+// There is no logical contention, so the difference comes from false sharing b/w neighboring carriers.
+constexpr std::size_t num_of_stripes = 64;
+
+template <typename STORAGE_T>
+std::vector<obj_mutex<long, std::mutex, STORAGE_T>>& get_striped_counter( void )
+{
+	static std::vector<obj_mutex<long, std::mutex, STORAGE_T>> counters = []() {
+		std::vector<obj_mutex<long, std::mutex, STORAGE_T>> ans;
+		ans.reserve( num_of_stripes );
+		for ( std::size_t i = 0; i < num_of_stripes; i++ ) {
+			ans.emplace_back( 0L );
+		}
+		return ans;
+	}();
+	return counters;
+}
+
+template <typename STORAGE_T>
+static void BM_striped_counter( benchmark::State& state )
+{
+	auto& counter = get_striped_counter<STORAGE_T>()[static_cast<std::size_t>( state.thread_index() ) % num_of_stripes];
+	for ( auto _ : state ) {
+		counter.with_lock( []( long& v ) { v++; } );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK_TEMPLATE( BM_striped_counter, shared_storage )->ThreadRange( 1, 64 )->UseRealTime();
+BENCHMARK_TEMPLATE( BM_striped_counter, intrusive_storage )->ThreadRange( 1, 64 )->UseRealTime();
+#if defined( __cpp_aligned_new )
+BENCHMARK_TEMPLATE( BM_striped_counter, cacheline_aligned )->ThreadRange( 1, 64 )->UseRealTime();
+#endif
+
+BENCHMARK_MAIN();
@@ -0,0 +1,366 @@
+// stress and latency harness of the lock policies of obj_mutex
+//
+// Each thread repeats a read or a write to one shared obj_mutex during the duration,
+// and records the time to acquire the lock into its own histogram.
+// The histograms are merged and printed as a percentile distribution in the style of HdrHistogram.
+//
+// usage: stress_object_mutex [--threads N] [--read-ratio PERCENT] [--hold-ns NS] [--duration-ms MS] [--policy NAME|all] [--distribution]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#if __cplusplus >= 201402L
+#include <shared_mutex>
+#endif
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "object_elided_mutex.hpp"
+#include "object_fair_mutex.hpp"
+#include "object_mutex.hpp"
+#include "object_reader_biased_mutex.hpp"
+#include "object_spin_mutex.hpp"
+#include "object_upgradable_mutex.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+inline std::int64_t now_ns( void )
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( clock_type::now().time_since_epoch() ).count();
+}
+
+/**
+ * @brief log-linear histogram of the latency in nanoseconds
+ *
+ * As same as HdrHistogram, each power of 2 range is divided into 2^sub_bucket_bits sub-buckets.
+ * Therefore the relative error of the recorded value is less than 1/2^sub_bucket_bits.
+ */
+class latency_histogram {
+public:
+	static constexpr unsigned int sub_bucket_bits  = 5;
+	static constexpr std::size_t  sub_bucket_count = std::size_t( 1 ) << sub_bucket_bits;
+	static constexpr std::size_t  bucket_count     = 64 - sub_bucket_bits + 1;
+
+	latency_histogram( void )
+	  : counts_( bucket_count * sub_bucket_count, 0 )
+	  , total_( 0 )
+	  , max_( 0 )
+	{
+	}
+
+	void record( std::uint64_t v )
+	{
+		counts_[index_of( v )]++;
+		total_++;
+		max_ = std::max( max_, v );
+	}
+
+	void merge( const latency_histogram& other )
+	{
+		for ( std::size_t i = 0; i < counts_.size(); i++ ) {
+			counts_[i] += other.counts_[i];
+		}
+		total_ += other.total_;
+		max_ = std::max( max_, other.max_ );
+	}
+
+	std::uint64_t total( void ) const
+	{
+		return total_;
+	}
+
+	std::uint64_t max( void ) const
+	{
+		return max_;
+	}
+
+	/**
+	 * @brief the highest value that is equivalent to the value at the percentile
+	 */
+	std::uint64_t value_at_percentile( double percentile ) const
+	{
+		if ( total_ == 0 ) {
+			return 0;
+		}
+		std::uint64_t target = static_cast<std::uint64_t>( std::ceil( percentile / 100.0 * static_cast<double>( total_ ) ) );
+		target               = std::max<std::uint64_t>( 1, std::min( target, total_ ) );
+		std::uint64_t acc    = 0;
+		for ( std::size_t i = 0; i < counts_.size(); i++ ) {
+			acc += counts_[i];
+			if ( acc >= target ) {
+				return std::min( highest_value_of( i ), max_ );
+			}
+		}
+		return max_;
+	}
+
+	/**
+	 * @brief print the percentile distribution in the format of HdrHistogram
+	 */
+	void print_distribution( std::FILE* fp ) const
+	{
+		std::fprintf( fp, "%12s %14s %10s %14s\n\n", "Value(ns)", "Percentile", "TotalCount", "1/(1-Percentile)" );
+		std::uint64_t acc = 0;
+		for ( std::size_t i = 0; i < counts_.size(); i++ ) {
+			if ( counts_[i] == 0 ) {
+				continue;
+			}
+			acc += counts_[i];
+			const double ratio = static_cast<double>( acc ) / static_cast<double>( total_ );
+			if ( acc < total_ ) {
+				std::fprintf( fp, "%12llu %14.12f %10llu %14.2f\n", static_cast<unsigned long long>( std::min( highest_value_of( i ), max_ ) ), ratio,
+				              static_cast<unsigned long long>( acc ), 1.0 / ( 1.0 - ratio ) );
+			} else {
+				std::fprintf( fp, "%12llu %14.12f %10llu\n", static_cast<unsigned long long>( max_ ), ratio, static_cast<unsigned long long>( acc ) );
+			}
+		}
+		std::fprintf( fp, "#[Max = %llu, Total count = %llu]\n", static_cast<unsigned long long>( max_ ), static_cast<unsigned long long>( total_ ) );
+	}
+
+private:
+	static std::size_t index_of( std::uint64_t v )
+	{
+		if ( v < sub_bucket_count ) {
+			return static_cast<std::size_t>( v );
+		}
+		unsigned int msb = 63;
+		while ( ( v >> msb ) == 0 ) {
+			msb--;
+		}
+		const unsigned int bucket = msb - sub_bucket_bits + 1;
+		const std::size_t  sub    = static_cast<std::size_t>( ( v >> ( bucket - 1 ) ) & ( sub_bucket_count - 1 ) );
+		return bucket * sub_bucket_count + sub;
+	}
+
+	static std::uint64_t highest_value_of( std::size_t idx )
+	{
+		const std::size_t bucket = idx / sub_bucket_count;
+		const std::size_t sub    = idx % sub_bucket_count;
+		if ( bucket == 0 ) {
+			return sub;
+		}
+		const std::uint64_t base = std::uint64_t( 1 ) << ( bucket + sub_bucket_bits - 1 );
+		const std::uint64_t unit = std::uint64_t( 1 ) << ( bucket - 1 );
+		return base + ( sub + 1 ) * unit - 1;
+	}
+
+	std::vector<std::uint64_t> counts_;
+	std::uint64_t              total_;
+	std::uint64_t              max_;
+};
+
+struct stress_config {
+	unsigned int num_threads = std::max( 2U, std::thread::hardware_concurrency() );
+	unsigned int read_ratio  = 90;   // percent
+	std::int64_t hold_ns     = 100;
+	std::int64_t duration_ms = 1000;
+	std::string  policy      = "all";
+	bool         print_distribution = false;
+};
+
+struct stress_result {
+	latency_histogram read_hist;
+	latency_histogram write_hist;
+	std::uint64_t     ops         = 0;
+	double            elapsed_sec = 0.0;
+};
+
+inline void hold_for( std::int64_t hold_ns )
+{
+	if ( hold_ns <= 0 ) {
+		return;
+	}
+	const std::int64_t end = now_ns() + hold_ns;
+	while ( now_ns() < end ) {
+	}
+}
+
+struct payload {
+	std::uint64_t a = 0;
+	std::uint64_t b = 0;
+};
+
+template <typename MTX_T, typename std::enable_if<obj_mutex_impl::is_shared_lockable<MTX_T>::value>::type* = nullptr>
+bool read_once( const obj_mutex<payload, MTX_T>& obj, std::int64_t hold_ns, latency_histogram& hist )
+{
+	const std::int64_t t0  = now_ns();
+	auto               acc = obj.lock_get_shared();
+	hist.record( static_cast<std::uint64_t>( now_ns() - t0 ) );
+	hold_for( hold_ns );
+	return acc.ref().a == acc.ref().b;
+}
+
+template <typename MTX_T, typename std::enable_if<!obj_mutex_impl::is_shared_lockable<MTX_T>::value>::type* = nullptr>
+bool read_once( const obj_mutex<payload, MTX_T>& obj, std::int64_t hold_ns, latency_histogram& hist )
+{
+	const std::int64_t t0  = now_ns();
+	auto               acc = obj.lock_get();
+	hist.record( static_cast<std::uint64_t>( now_ns() - t0 ) );
+	hold_for( hold_ns );
+	return acc.ref().a == acc.ref().b;
+}
+
+template <typename MTX_T>
+void write_once( obj_mutex<payload, MTX_T>& obj, std::int64_t hold_ns, latency_histogram& hist )
+{
+	const std::int64_t t0  = now_ns();
+	auto               acc = obj.lock_get();
+	hist.record( static_cast<std::uint64_t>( now_ns() - t0 ) );
+	acc.ref().a++;
+	hold_for( hold_ns );
+	acc.ref().b++;
+}
+
+template <typename MTX_T>
+stress_result run_stress( const stress_config& cfg, bool* p_is_consistent )
+{
+	obj_mutex<payload, MTX_T>      obj;
+	std::atomic<bool>              is_started( false );
+	std::atomic<bool>              is_stopped( false );
+	std::atomic<bool>              is_consistent( true );
+	std::vector<stress_result>     results( cfg.num_threads );
+	std::vector<std::thread>       threads;
+
+	for ( unsigned int i = 0; i < cfg.num_threads; i++ ) {
+		threads.emplace_back( [&, i]() {
+			stress_result& r   = results[i];
+			std::uint64_t  rnd = 0x9E3779B97F4A7C15ULL * ( i + 1 );
+			while ( !is_started.load( std::memory_order_acquire ) ) {
+				std::this_thread::yield();
+			}
+			while ( !is_stopped.load( std::memory_order_relaxed ) ) {
+				rnd ^= rnd << 13;
+				rnd ^= rnd >> 7;
+				rnd ^= rnd << 17;
+				if ( ( rnd % 100 ) < cfg.read_ratio ) {
+					if ( !read_once<MTX_T>( obj, cfg.hold_ns, r.read_hist ) ) {
+						is_consistent.store( false, std::memory_order_relaxed );
+					}
+				} else {
+					write_once<MTX_T>( obj, cfg.hold_ns, r.write_hist );
+				}
+				r.ops++;
+			}
+		} );
+	}
+
+	const clock_type::time_point t_start = clock_type::now();
+	is_started.store( true, std::memory_order_release );
+	std::this_thread::sleep_for( std::chrono::milliseconds( cfg.duration_ms ) );
+	is_stopped.store( true, std::memory_order_relaxed );
+	for ( auto& t : threads ) {
+		t.join();
+	}
+	const clock_type::time_point t_end = clock_type::now();
+
+	stress_result ans;
+	for ( const auto& r : results ) {
+		ans.read_hist.merge( r.read_hist );
+		ans.write_hist.merge( r.write_hist );
+		ans.ops += r.ops;
+	}
+	ans.elapsed_sec = std::chrono::duration<double>( t_end - t_start ).count();
+
+	const payload last = obj.lock_get().ref();
+	*p_is_consistent   = is_consistent.load() && last.a == last.b && last.a == ans.write_hist.total();
+	return ans;
+}
+
+void print_summary_line( const char* p_kind, const latency_histogram& hist )
+{
+	std::printf( "  %-5s count=%-10llu p50=%-8llu p99=%-8llu p999=%-8llu max=%llu (ns)\n", p_kind,
+	             static_cast<unsigned long long>( hist.total() ),
+	             static_cast<unsigned long long>( hist.value_at_percentile( 50.0 ) ),
+	             static_cast<unsigned long long>( hist.value_at_percentile( 99.0 ) ),
+	             static_cast<unsigned long long>( hist.value_at_percentile( 99.9 ) ),
+	             static_cast<unsigned long long>( hist.max() ) );
+}
+
+template <typename MTX_T>
+bool run_policy( const char* p_name, const stress_config& cfg )
+{
+	if ( cfg.policy != "all" && cfg.policy != p_name ) {
+		return true;
+	}
+
+	bool                is_consistent = false;
+	const stress_result r             = run_stress<MTX_T>( cfg, &is_consistent );
+	std::printf( "%s: threads=%u read_ratio=%u%% hold_ns=%lld ops/sec=%.0f%s\n", p_name, cfg.num_threads, cfg.read_ratio,
+	             static_cast<long long>( cfg.hold_ns ), static_cast<double>( r.ops ) / r.elapsed_sec, is_consistent ? "" : " INCONSISTENT" );
+	print_summary_line( "read", r.read_hist );
+	print_summary_line( "write", r.write_hist );
+	if ( cfg.print_distribution ) {
+		std::printf( "read acquisition latency:\n" );
+		r.read_hist.print_distribution( stdout );
+		std::printf( "write acquisition latency:\n" );
+		r.write_hist.print_distribution( stdout );
+	}
+	std::fflush( stdout );
+	return is_consistent;
+}
+
+bool parse_args( int argc, char* argv[], stress_config* p_cfg )
+{
+	for ( int i = 1; i < argc; i++ ) {
+		const char* p_opt = argv[i];
+		if ( std::strcmp( p_opt, "--distribution" ) == 0 ) {
+			p_cfg->print_distribution = true;
+			continue;
+		}
+		if ( i + 1 >= argc ) {
+			return false;
+		}
+		const char* p_val = argv[++i];
+		if ( std::strcmp( p_opt, "--threads" ) == 0 ) {
+			p_cfg->num_threads = static_cast<unsigned int>( std::max( 1L, std::strtol( p_val, nullptr, 10 ) ) );
+		} else if ( std::strcmp( p_opt, "--read-ratio" ) == 0 ) {
+			p_cfg->read_ratio = static_cast<unsigned int>( std::min( 100L, std::max( 0L, std::strtol( p_val, nullptr, 10 ) ) ) );
+		} else if ( std::strcmp( p_opt, "--hold-ns" ) == 0 ) {
+			p_cfg->hold_ns = std::strtoll( p_val, nullptr, 10 );
+		} else if ( std::strcmp( p_opt, "--duration-ms" ) == 0 ) {
+			p_cfg->duration_ms = std::max( 1LL, std::strtoll( p_val, nullptr, 10 ) );
+		} else if ( std::strcmp( p_opt, "--policy" ) == 0 ) {
+			p_cfg->policy = p_val;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+}   // namespace
+
+int main( int argc, char* argv[] )
+{
+	stress_config cfg;
+	if ( !parse_args( argc, argv, &cfg ) ) {
+		std::fprintf( stderr, "usage: %s [--threads N] [--read-ratio PERCENT] [--hold-ns NS] [--duration-ms MS] [--policy NAME|all] [--distribution]\n", argv[0] );
+		std::fprintf( stderr, "policies: std_mutex spin fair elided shared_mutex upgradable reader_biased\n" );
+		return 2;
+	}
+
+	bool is_ok = true;
+	is_ok      = run_policy<std::mutex>( "std_mutex", cfg ) && is_ok;
+	is_ok      = run_policy<obj_spin_mutex>( "spin", cfg ) && is_ok;
+	is_ok      = run_policy<obj_fair_mutex>( "fair", cfg ) && is_ok;
+	is_ok      = run_policy<obj_elided_mutex<>>( "elided", cfg ) && is_ok;
+#if defined( __cpp_lib_shared_timed_mutex )
+	is_ok = run_policy<std::shared_timed_mutex>( "shared_mutex", cfg ) && is_ok;
+#endif
+#if ( __cplusplus >= 201402L ) && defined( __cpp_lib_shared_timed_mutex )
+	// obj_upgradable_mutexとobj_reader_biased_mutexはC++14以降で定義され、少なくともstd::shared_timed_mutexを必要とする。
+	is_ok = run_policy<obj_upgradable_mutex<>>( "upgradable", cfg ) && is_ok;
+	is_ok = run_policy<obj_reader_biased_mutex<>>( "reader_biased", cfg ) && is_ok;
+#endif
+
+	return is_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,9 +1,20 @@
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
 #include <mutex>
+#if __cplusplus >= 201402L
+#include <shared_mutex>
+#endif
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 #include "object_mutex.hpp"
 
@@ -85,6 +96,25 @@ TEST( ObjectMutex, Locked_move2 )
 	return;
 }
 
+TEST( ObjectMutex, Locked_move2_does_not_overwrite_the_object )
+{
+	obj_mutex<test_class1> tt11( 11, 12 );
+	obj_mutex<test_class1> tt12( 21, 22 );
+
+	{
+		auto locked_data1 = tt11.lock_get();
+		auto locked_data2 = tt12.lock_get();
+
+		locked_data2 = std::move( locked_data1 );
+		EXPECT_FALSE( tt12.is_locked() );
+	}
+
+	EXPECT_EQ( 21, tt12.lock_get().ref().a );
+	EXPECT_EQ( 22, tt12.lock_get().ref().b );
+
+	return;
+}
+
 TEST( ObjectMutex, RecusiveMutexLocked )
 {
 	obj_mutex<test_class1, std::recursive_mutex> tt3;
@@ -370,6 +400,28 @@ TEST( ObjectMutex, shared_clone_has_the_relationship )
 	return;
 }
 
+TEST( ObjectMutex, shared_clone_with_up_cast_and_down_cast )
+{
+	obj_mutex<test_classB> ttB( 21 );
+	ttB.lock_get().ref().a = 20;
+
+	obj_mutex<test_classA> ttA = ttB.shared_clone<test_classA>();
+	EXPECT_EQ( 20, ttA.lock_get().ref().a );
+
+	obj_mutex<test_classB> ttB2 = ttA.shared_clone<test_classB>();
+	EXPECT_EQ( 21, ttB2.lock_get().ref().b );
+	{
+		auto locked_acc = ttB2.lock_get();
+		EXPECT_TRUE( ttA.is_locked() );
+		EXPECT_TRUE( ttB.is_locked() );
+	}
+
+	obj_mutex<test_classA> ttA2;
+	EXPECT_THROW( ttA2.shared_clone<test_classB>(), std::bad_cast );
+
+	return;
+}
+
 class test_class4 {
 public:
 	test_class4( std::unique_ptr<int> up_b_arg )
@@ -523,3 +575,840 @@ TEST( ObjectMutex, accesseser_has_been_moved )
 	EXPECT_THROW( ac.ref(), std::logic_error );
 	EXPECT_NO_THROW( ac2.ref() );
 }
+
+#if defined( __cpp_lib_shared_mutex )
+struct is_callable_lock_get_shared_impl {
+	template <typename T, typename MTX_T>
+	static auto check( obj_mutex<T, MTX_T>* p ) -> decltype( p->lock_get_shared(), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_lock_get_shared : decltype( is_callable_lock_get_shared_impl::check<T, MTX_T>( nullptr ) ) {};
+
+TEST( ObjectMutex, lock_get_shared_is_available_only_for_shared_mutex )
+{
+	static_assert( is_callable_lock_get_shared<test_class1, std::shared_mutex>::value, "should be callable with std::shared_mutex" );
+	static_assert( !is_callable_lock_get_shared<test_class1, std::mutex>::value, "should not be callable with std::mutex" );
+	static_assert( std::is_same<decltype( std::declval<obj_mutex<test_class1, std::shared_mutex>&>().lock_get_shared().ref() ), const test_class1&>::value,
+	               "read_accessor should provide only const reference" );
+	return;
+}
+
+TEST( ObjectMutex, SharedMutexLocked )
+{
+	obj_mutex<test_class1, std::shared_mutex> tt( 1, 2 );
+
+	{
+		auto read_acc = tt.lock_get_shared();
+		EXPECT_TRUE( read_acc.valid() );
+		EXPECT_EQ( 1, read_acc.ref().a );
+		EXPECT_TRUE( tt.is_locked() );
+	}
+	EXPECT_FALSE( tt.is_locked() );
+
+	{
+		auto locked_data = tt.lock_get();
+		locked_data.ref().a = 10;
+	}
+	EXPECT_EQ( 10, tt.lock_get_shared().ref().a );
+
+	return;
+}
+
+TEST( ObjectMutex, SharedMutex_readers_at_the_same_time )
+{
+	obj_mutex<test_class1, std::shared_mutex> tt( 1, 2 );
+
+	auto read_acc1 = tt.lock_get_shared();
+
+	int  ret_a = 0;
+	auto th    = std::thread( [&tt, &ret_a]() {
+		auto read_acc2 = tt.lock_get_shared();   // should not be blocked by read_acc1
+		ret_a          = read_acc2.ref().a;
+	} );
+	th.join();
+
+	EXPECT_EQ( 1, ret_a );
+	EXPECT_EQ( 1, read_acc1.ref().a );
+
+	return;
+}
+
+TEST( ObjectMutex, SharedMutex_read_accessor_move )
+{
+	obj_mutex<int, std::shared_mutex> tt1( 11 );
+	obj_mutex<int, std::shared_mutex> tt2( 12 );
+
+	auto read_acc1 = tt1.lock_get_shared();
+	auto read_acc2 = tt2.lock_get_shared();
+	auto read_acc3 = std::move( read_acc1 );
+	EXPECT_FALSE( read_acc1.valid() );
+	EXPECT_THROW( read_acc1.ref(), std::logic_error );
+	EXPECT_EQ( 11, read_acc3.ref() );
+
+	read_acc2 = std::move( read_acc3 );
+	EXPECT_FALSE( tt2.is_locked() );
+	EXPECT_TRUE( tt1.is_locked() );
+	EXPECT_EQ( 11, read_acc2.ref() );
+
+	return;
+}
+
+TEST( ObjectMutex, SharedMutex_lock_get_shared_upcast )
+{
+	obj_mutex<test_classB, std::shared_mutex> ttB( 21 );
+	ttB.lock_get().ref().a = 20;
+
+	EXPECT_EQ( 20, ttB.lock_get_shared<test_classA>().ref().a );
+
+	obj_mutex<test_classB, std::shared_mutex> ttB2 = std::move( ttB );
+	EXPECT_THROW( ttB.lock_get_shared(), std::logic_error );
+
+	return;
+}
+#endif
+
+TEST( ObjectMutex, with_lock )
+{
+	obj_mutex<test_class1> tt( 1, 2 );
+
+	tt.with_lock( [&tt]( test_class1& d ) {
+		EXPECT_TRUE( tt.is_locked() );
+		d.a = 10;
+	} );
+	EXPECT_FALSE( tt.is_locked() );
+
+	const obj_mutex<test_class1>& ref_tt = tt;
+	int                           ret    = ref_tt.with_lock( []( const test_class1& d ) { return d.a + d.b; } );
+	EXPECT_EQ( 12, ret );
+
+	return;
+}
+
+TEST( ObjectMutex, with_lock_releases_the_lock_by_exception )
+{
+	obj_mutex<int> tt_int( 11 );
+
+	EXPECT_THROW( tt_int.with_lock( []( int& ) { throw std::runtime_error( "test" ); } ), std::runtime_error );
+	EXPECT_FALSE( tt_int.is_locked() );
+
+	obj_mutex<int> tt_int1 = std::move( tt_int );
+	EXPECT_THROW( tt_int.with_lock( []( int& d ) { return d; } ), std::logic_error );
+	EXPECT_EQ( 11, tt_int1.with_lock( []( int& d ) { return d; } ) );
+
+	return;
+}
+
+#if defined( __cpp_lib_shared_mutex )
+TEST( ObjectMutex, with_lock_shared )
+{
+	obj_mutex<test_class1, std::shared_mutex> tt( 1, 2 );
+
+	int ret = tt.with_lock_shared( [&tt]( const test_class1& d ) {
+		EXPECT_TRUE( tt.is_locked() );
+		return d.b;
+	} );
+	EXPECT_EQ( 2, ret );
+	EXPECT_FALSE( tt.is_locked() );
+
+	return;
+}
+#endif
+
+class test_class_count {
+public:
+	test_class_count( int a_arg = 0 )
+	  : a( a_arg )
+	{
+		count++;
+	}
+	~test_class_count()
+	{
+		count--;
+	}
+
+	int a;
+
+	static int count;
+};
+int test_class_count::count = 0;
+
+TEST( ObjectMutex, IntrusiveStorage_basic )
+{
+	obj_mutex<test_class1, std::mutex, intrusive_storage> tt1( 1, 2 );
+	obj_mutex<int, std::mutex, intrusive_storage>         tt_int( 11 );
+
+	EXPECT_EQ( 1, tt1.lock_get().ref().a );
+	EXPECT_EQ( 11, tt_int.lock_get().ref() );
+	{
+		auto locked_acc = tt1.lock_get();
+		EXPECT_TRUE( tt1.is_locked() );
+	}
+	EXPECT_FALSE( tt1.is_locked() );
+
+	obj_mutex<test_class1, std::mutex, intrusive_storage> tt2 = std::move( tt1 );
+	EXPECT_FALSE( tt1.valid() );
+	EXPECT_THROW( tt1.lock_get(), std::logic_error );
+	EXPECT_EQ( 2, tt2.lock_get().ref().b );
+
+	obj_mutex<test_class1, std::mutex, intrusive_storage> tt3 = tt2.clone();
+	tt3.lock_get().ref().a                                     = 10;
+	EXPECT_EQ( 1, tt2.lock_get().ref().a );
+
+	return;
+}
+
+TEST( ObjectMutex, IntrusiveStorage_shared_clone_and_release )
+{
+	ASSERT_EQ( 0, test_class_count::count );
+	{
+		obj_mutex<test_class_count, std::mutex, intrusive_storage> tt1( 1 );
+		EXPECT_EQ( 1, test_class_count::count );
+		{
+			obj_mutex<test_class_count, std::mutex, intrusive_storage> tt2 = tt1.shared_clone();
+			tt2.lock_get().ref().a                                          = 10;
+
+			auto locked_acc = tt1.lock_get();
+			EXPECT_TRUE( tt2.is_locked() );
+			EXPECT_EQ( 10, locked_acc.ref().a );
+		}
+		EXPECT_EQ( 1, test_class_count::count );
+
+		auto locked_acc = tt1.lock_get();
+		obj_mutex<test_class_count, std::mutex, intrusive_storage> tt3 = std::move( tt1 );
+		tt3                                                             = obj_mutex<test_class_count, std::mutex, intrusive_storage>( 2 );
+		EXPECT_EQ( 2, test_class_count::count );   // locked_acc keeps the 1st carrier
+		EXPECT_EQ( 10, locked_acc.ref().a );
+	}
+	EXPECT_EQ( 0, test_class_count::count );
+
+	return;
+}
+
+TEST( ObjectMutex, IntrusiveStorage_up_cast_and_down_cast )
+{
+	obj_mutex<test_classB, std::mutex, intrusive_storage> ttB( 21 );
+	ttB.lock_get().ref().a = 20;
+
+	obj_mutex<test_classA, std::mutex, intrusive_storage> ttA = std::move( ttB );
+	EXPECT_EQ( 20, ttA.lock_get().ref().a );
+	EXPECT_EQ( 21, ttA.lock_get<test_classB>().ref().b );
+
+	obj_mutex<test_classB, std::mutex, intrusive_storage> ttB2 = std::move( ttA );
+	EXPECT_EQ( 21, ttB2.lock_get().ref().b );
+
+	obj_mutex<test_classA, std::mutex, intrusive_storage> ttA2;
+	EXPECT_THROW( ttA2.lock_get<test_classB>(), std::bad_cast );
+	using intrusive_objB_t = obj_mutex<test_classB, std::mutex, intrusive_storage>;
+	EXPECT_THROW( intrusive_objB_t xx( std::move( ttA2 ) ), std::bad_cast );
+	EXPECT_TRUE( ttA2.valid() );
+
+	return;
+}
+
+TEST( ObjectMutex, InlineStorage_basic )
+{
+	static_assert( !std::is_move_constructible<obj_mutex<int, std::mutex, inline_storage>>::value, "inline_storage should not be movable" );
+	static_assert( sizeof( obj_mutex<int, std::mutex, inline_storage> ) <= sizeof( std::mutex ) + alignof( std::mutex ), "inline_storage should have only T and MTX_T" );
+
+	obj_mutex<test_class1, std::mutex, inline_storage> tt1( 1, 2 );
+	obj_mutex<int, std::mutex, inline_storage>         tt_int( 11 );
+
+	EXPECT_TRUE( tt1.valid() );
+	EXPECT_EQ( 1, tt1.lock_get().ref().a );
+	EXPECT_EQ( 11, tt_int.lock_get().ref() );
+	{
+		auto locked_acc1 = tt1.lock_get();
+		EXPECT_TRUE( tt1.is_locked() );
+		locked_acc1.ref().a = 10;
+
+		auto locked_acc2 = std::move( locked_acc1 );
+		EXPECT_FALSE( locked_acc1.valid() );
+		EXPECT_THROW( locked_acc1.ref(), std::logic_error );
+		EXPECT_TRUE( tt1.is_locked() );
+	}
+	EXPECT_FALSE( tt1.is_locked() );
+	EXPECT_EQ( 12, tt1.with_lock( []( test_class1& d ) { return d.a + d.b; } ) );
+
+	obj_mutex<test_class1> tt2 = tt1.clone<test_class1, std::mutex, shared_storage>();
+	EXPECT_EQ( 10, tt2.lock_get().ref().a );
+
+	return;
+}
+
+#if defined( __cpp_lib_shared_mutex )
+TEST( ObjectMutex, InlineStorage_up_cast_and_shared_lock )
+{
+	obj_mutex<test_classB, std::shared_mutex, inline_storage> ttB( 21 );
+
+	EXPECT_EQ( 0, ttB.lock_get<test_classA>().ref().a );
+	{
+		auto read_acc = ttB.lock_get_shared<test_classA>();
+		EXPECT_TRUE( ttB.is_locked() );
+		EXPECT_EQ( 0, read_acc.ref().a );
+	}
+	EXPECT_EQ( 21, ttB.with_lock_shared( []( const test_classB& d ) { return d.b; } ) );
+
+	return;
+}
+#endif
+
+template <typename T>
+class test_counting_allocator {
+public:
+	using value_type = T;
+
+	test_counting_allocator( int* p_count_arg )
+	  : p_count_( p_count_arg )
+	{
+	}
+	template <typename U>
+	test_counting_allocator( const test_counting_allocator<U>& orig )
+	  : p_count_( orig.p_count_ )
+	{
+	}
+
+	T* allocate( std::size_t n )
+	{
+		( *p_count_ )++;
+		return std::allocator<T>().allocate( n );
+	}
+	void deallocate( T* p, std::size_t n )
+	{
+		( *p_count_ )--;
+		std::allocator<T>().deallocate( p, n );
+	}
+
+	template <typename U>
+	bool operator==( const test_counting_allocator<U>& other ) const
+	{
+		return p_count_ == other.p_count_;
+	}
+	template <typename U>
+	bool operator!=( const test_counting_allocator<U>& other ) const
+	{
+		return p_count_ != other.p_count_;
+	}
+
+	int* p_count_;
+};
+
+TEST( ObjectMutex, Allocator_shared_storage )
+{
+	int count = 0;
+	{
+		obj_mutex<test_class1> tt1( std::allocator_arg, test_counting_allocator<test_class1>( &count ), 1, 2 );
+		obj_mutex<int>         tt_int( std::allocator_arg, test_counting_allocator<int>( &count ), 11 );
+		EXPECT_EQ( 2, count );
+		EXPECT_EQ( 1, tt1.lock_get().ref().a );
+		EXPECT_EQ( 11, tt_int.lock_get().ref() );
+
+		obj_mutex<test_class1> tt2 = tt1.shared_clone();
+		EXPECT_EQ( 2, count );
+	}
+	EXPECT_EQ( 0, count );
+
+	return;
+}
+
+TEST( ObjectMutex, Allocator_intrusive_storage )
+{
+	int count = 0;
+	ASSERT_EQ( 0, test_class_count::count );
+	{
+		obj_mutex<test_class_count, std::mutex, intrusive_storage> tt1( std::allocator_arg, test_counting_allocator<char>( &count ), 3 );
+		obj_mutex<test_class1, std::mutex, intrusive_storage>      tt2( std::allocator_arg, test_counting_allocator<char>( &count ) );
+		EXPECT_EQ( 2, count );
+		EXPECT_EQ( 1, test_class_count::count );
+		EXPECT_EQ( 3, tt1.lock_get().ref().a );
+		EXPECT_EQ( 10, tt2.lock_get().ref().a );
+
+		obj_mutex<test_class_count, std::mutex, intrusive_storage> tt3 = tt1.shared_clone();
+		EXPECT_EQ( 2, count );
+	}
+	EXPECT_EQ( 0, count );
+	EXPECT_EQ( 0, test_class_count::count );
+
+	return;
+}
+
+#if defined( __cpp_lib_memory_resource )
+TEST( ObjectMutex, Allocator_pmr_memory_resource )
+{
+	std::pmr::monotonic_buffer_resource  pool;
+	std::pmr::polymorphic_allocator<int> alloc( &pool );
+
+	obj_mutex<int>                                        tt1( std::allocator_arg, alloc, 11 );
+	obj_mutex<test_class1, std::mutex, intrusive_storage> tt2( std::allocator_arg, alloc, 1, 2 );
+
+	EXPECT_EQ( 11, tt1.lock_get().ref() );
+	EXPECT_EQ( 2, tt2.lock_get().ref().b );
+
+	return;
+}
+#endif
+
+#if defined( __cpp_aligned_new )
+TEST( ObjectMutex, CachelineAligned_layout )
+{
+	obj_mutex<test_class1, std::mutex, cacheline_aligned> tt1( 1, 2 );
+	obj_mutex<int, std::mutex, cacheline_aligned>         tt_int( 11 );
+
+	auto locked_acc1 = tt1.lock_get();
+	auto locked_acc2 = tt_int.lock_get();
+	EXPECT_EQ( 0U, reinterpret_cast<std::uintptr_t>( &( locked_acc1.ref() ) ) % OBJECT_MUTEX_CACHE_LINE_SIZE );
+	EXPECT_EQ( 0U, reinterpret_cast<std::uintptr_t>( &( locked_acc2.ref() ) ) % OBJECT_MUTEX_CACHE_LINE_SIZE );
+	EXPECT_EQ( 1, locked_acc1.ref().a );
+	EXPECT_EQ( 11, locked_acc2.ref() );
+
+	return;
+}
+
+TEST( ObjectMutex, CachelineAligned_cast_and_shared_clone )
+{
+	obj_mutex<test_classB, std::mutex, cacheline_aligned> ttB( 21 );
+	obj_mutex<test_classA, std::mutex, cacheline_aligned> ttA = ttB.shared_clone<test_classA>();
+
+	{
+		auto locked_acc = ttA.lock_get();
+		EXPECT_TRUE( ttB.is_locked() );
+	}
+	EXPECT_EQ( 21, ttA.lock_get<test_classB>().ref().b );
+
+	obj_mutex<test_class1> tt = obj_mutex<test_class1, std::mutex, cacheline_aligned>( 1, 2 ).clone<test_class1, std::mutex, shared_storage>();
+	EXPECT_EQ( 2, tt.lock_get().ref().b );
+
+	return;
+}
+#endif
+
+#if __cplusplus >= 201402L
+TEST( ObjectMutex, lock_get_all )
+{
+	obj_mutex<int>                                     tt_a( 100 );
+	obj_mutex<int, std::recursive_mutex>               tt_b( 0 );
+	obj_mutex<test_class1, std::mutex, inline_storage> tt_c( 1, 2 );
+
+	{
+		auto accs = lock_get_all( tt_a, tt_b, tt_c );
+		EXPECT_TRUE( tt_a.is_locked() );
+		EXPECT_TRUE( tt_c.is_locked() );
+		std::get<0>( accs ).ref() -= 30;
+		std::get<1>( accs ).ref() += 30;
+		std::get<2>( accs ).ref().a = 10;
+	}
+	EXPECT_FALSE( tt_a.is_locked() );
+	EXPECT_FALSE( tt_c.is_locked() );
+	EXPECT_EQ( 70, tt_a.lock_get().ref() );
+	EXPECT_EQ( 30, tt_b.lock_get().ref() );
+	EXPECT_EQ( 10, tt_c.lock_get().ref().a );
+
+	return;
+}
+
+TEST( ObjectMutex, lock_get_all_with_shared_clone )
+{
+	obj_mutex<test_classB> ttB( 21 );
+	obj_mutex<test_classA> ttA  = ttB.shared_clone<test_classA>();
+	obj_mutex<test_classB> ttB2 = ttB.shared_clone();
+
+	{
+		auto accs = lock_get_all( ttB, ttA, ttB2 );
+		EXPECT_TRUE( ttB.is_locked() );
+		EXPECT_TRUE( std::get<0>( accs ).valid() );
+		EXPECT_TRUE( std::get<1>( accs ).valid() );
+		EXPECT_TRUE( std::get<2>( accs ).valid() );
+		std::get<2>( accs ).ref().b = 22;
+	}
+	EXPECT_FALSE( ttB.is_locked() );
+	EXPECT_EQ( 22, ttB.lock_get().ref().b );
+
+	obj_mutex<test_classB> ttB3 = std::move( ttB2 );
+	EXPECT_THROW( lock_get_all( ttB, ttB2 ), std::logic_error );
+	EXPECT_FALSE( ttB.is_locked() );
+
+	return;
+}
+
+TEST( ObjectMutex, lock_get_all_does_not_deadlock )
+{
+	obj_mutex<int> tt_a( 0 );
+	obj_mutex<int> tt_b( 0 );
+
+	constexpr int loop_num = 10000;
+	auto          transfer = []( obj_mutex<int>& from, obj_mutex<int>& to ) {
+		for ( int i = 0; i < loop_num; i++ ) {
+			auto accs = lock_get_all( from, to );
+			std::get<0>( accs ).ref()--;
+			std::get<1>( accs ).ref()++;
+		}
+	};
+	std::thread t1( transfer, std::ref( tt_a ), std::ref( tt_b ) );
+	std::thread t2( transfer, std::ref( tt_b ), std::ref( tt_a ) );
+	t1.join();
+	t2.join();
+
+	EXPECT_EQ( 0, tt_a.lock_get().ref() );
+	EXPECT_EQ( 0, tt_b.lock_get().ref() );
+
+	return;
+}
+#endif
+
+struct is_callable_try_lock_get_for_impl {
+	template <typename T, typename MTX_T>
+	static auto check( obj_mutex<T, MTX_T>* p ) -> decltype( p->try_lock_get_for( std::chrono::milliseconds( 1 ) ), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_try_lock_get_for : decltype( is_callable_try_lock_get_for_impl::check<T, MTX_T>( nullptr ) ) {};
+
+TEST( ObjectMutex, try_lock_get_for_is_available_only_for_timed_mutex )
+{
+	static_assert( is_callable_try_lock_get_for<test_class1, std::timed_mutex>::value, "should be callable with std::timed_mutex" );
+	static_assert( !is_callable_try_lock_get_for<test_class1, std::mutex>::value, "should not be callable with std::mutex" );
+	return;
+}
+
+TEST( ObjectMutex, try_lock_get )
+{
+	obj_mutex<test_classB> ttB( 21 );
+
+	{
+		auto locked_acc = ttB.try_lock_get<test_classA>();
+		EXPECT_TRUE( locked_acc.valid() );
+		EXPECT_TRUE( ttB.is_locked() );
+
+		std::thread t( [&ttB]() {
+			auto acc = ttB.try_lock_get();
+			EXPECT_FALSE( acc.valid() );
+			EXPECT_THROW( acc.ref(), std::logic_error );
+		} );
+		t.join();
+	}
+	EXPECT_FALSE( ttB.is_locked() );
+
+	const obj_mutex<test_classB>& ref_ttB = ttB;
+	auto                          acc     = ref_ttB.try_lock_get();
+	EXPECT_TRUE( acc.valid() );
+	EXPECT_EQ( 21, acc.ref().b );
+
+	obj_mutex<test_classB> ttB2 = std::move( ttB );
+	EXPECT_THROW( ttB.try_lock_get(), std::logic_error );
+
+	return;
+}
+
+TEST( ObjectMutex, try_lock_get_for_and_until )
+{
+	obj_mutex<int, std::timed_mutex> tt_int( 11 );
+
+	{
+		auto locked_acc = tt_int.try_lock_get_for( std::chrono::milliseconds( 1 ) );
+		EXPECT_TRUE( locked_acc.valid() );
+
+		std::thread t( [&tt_int]() {
+			EXPECT_FALSE( tt_int.try_lock_get_for( std::chrono::milliseconds( 1 ) ).valid() );
+			EXPECT_FALSE( tt_int.try_lock_get_until( std::chrono::steady_clock::now() + std::chrono::milliseconds( 1 ) ).valid() );
+		} );
+		t.join();
+	}
+
+	auto acc = tt_int.try_lock_get_until( std::chrono::steady_clock::now() + std::chrono::milliseconds( 1 ) );
+	EXPECT_TRUE( acc.valid() );
+	EXPECT_EQ( 11, acc.ref() );
+
+	return;
+}
+
+TEST( ObjectMutex, InlineStorage_try_lock_get )
+{
+	obj_mutex<test_class1, std::timed_mutex, inline_storage> tt( 1, 2 );
+
+	{
+		auto locked_acc = tt.try_lock_get();
+		EXPECT_TRUE( locked_acc.valid() );
+
+		std::thread t( [&tt]() {
+			EXPECT_FALSE( tt.try_lock_get().valid() );
+			EXPECT_FALSE( tt.try_lock_get_for( std::chrono::milliseconds( 1 ) ).valid() );
+		} );
+		t.join();
+	}
+
+	EXPECT_EQ( 2, tt.try_lock_get_until( std::chrono::steady_clock::now() ).ref().b );
+
+	return;
+}
+
+TEST( ObjectMutex, batch_flushes_when_the_buffer_fills )
+{
+	obj_mutex<std::vector<int>> tt;
+
+	{
+		auto bt = tt.batch( 3 );
+		bt.submit( []( std::vector<int>& d ) { d.push_back( 1 ); } );
+		bt.submit( []( std::vector<int>& d ) { d.push_back( 2 ); } );
+		EXPECT_EQ( 2U, bt.pending() );
+		EXPECT_TRUE( tt.lock_get().ref().empty() );
+
+		bt.submit( []( std::vector<int>& d ) { d.push_back( 3 ); } );
+		EXPECT_EQ( 0U, bt.pending() );
+		EXPECT_EQ( 3U, tt.lock_get().ref().size() );
+
+		bt.submit( []( std::vector<int>& d ) { d.push_back( 4 ); } );
+		bt.flush();
+		EXPECT_EQ( 4U, tt.lock_get().ref().size() );
+
+		bt.submit( []( std::vector<int>& d ) { d.push_back( 5 ); } );
+	}
+	EXPECT_EQ( 5U, tt.lock_get().ref().size() );   // flushed by the destructor
+	EXPECT_EQ( 5, tt.lock_get().ref()[4] );
+
+	return;
+}
+
+TEST( ObjectMutex, batch_with_move_only_operation )
+{
+	obj_mutex<std::vector<std::unique_ptr<int>>, std::mutex, inline_storage> tt;
+
+	struct push_unique {
+		std::unique_ptr<int> up_;
+
+		void operator()( std::vector<std::unique_ptr<int>>& d )
+		{
+			d.push_back( std::move( up_ ) );
+		}
+	};
+
+	auto                 bt = tt.batch();
+	std::unique_ptr<int> up( new int( 7 ) );
+	bt.submit( push_unique { std::move( up ) } );
+	auto bt2 = std::move( bt );
+	EXPECT_THROW( bt.submit( []( std::vector<std::unique_ptr<int>>& ) {} ), std::logic_error );
+	bt2.flush();
+	EXPECT_EQ( 7, *( tt.lock_get().ref()[0] ) );
+
+	return;
+}
+
+TEST( ObjectMutex, batch_exception )
+{
+	obj_mutex<int> tt( 0 );
+
+	auto bt = tt.batch();
+	bt.submit( []( int& d ) { d++; } );
+	bt.submit( []( int& ) { throw std::runtime_error( "test" ); } );
+	bt.submit( []( int& d ) { d++; } );
+	EXPECT_THROW( bt.flush(), std::runtime_error );
+	EXPECT_EQ( 0U, bt.pending() );
+	EXPECT_FALSE( tt.is_locked() );
+	EXPECT_EQ( 1, tt.lock_get().ref() );
+
+	obj_mutex<int> tt2 = std::move( tt );
+	EXPECT_THROW( tt.batch(), std::logic_error );
+
+	return;
+}
+
+TEST( ObjectMutex, clone_into_reuses_the_destination )
+{
+	obj_mutex<std::vector<int>> tt_src( std::vector<int> { 1, 2, 3 } );
+	obj_mutex<std::vector<int>> tt_dst( std::vector<int>( 16, 0 ) );
+	const int*                  p_dst_buf = tt_dst.lock_get().ref().data();
+
+	tt_src.clone_into( tt_dst );
+	EXPECT_EQ( ( std::vector<int> { 1, 2, 3 } ), tt_dst.lock_get().ref() );
+	EXPECT_EQ( p_dst_buf, tt_dst.lock_get().ref().data() );   // no reallocation
+	EXPECT_FALSE( tt_src.is_locked() );
+	EXPECT_FALSE( tt_dst.is_locked() );
+
+	// to the other mutex, the other storage, and the base class
+	obj_mutex<std::vector<int>, std::recursive_mutex, inline_storage> tt_inline;
+	tt_src.clone_into( tt_inline );
+	EXPECT_EQ( 3U, tt_inline.lock_get().ref().size() );
+
+	obj_mutex<test_classB> tt_derived;
+	obj_mutex<test_classA> tt_base;
+	tt_derived.lock_get().ref().a = 5;
+	tt_derived.clone_into( tt_base );
+	EXPECT_EQ( 5, tt_base.lock_get().ref().a );
+
+	// to the object that shares the same mutex
+	obj_mutex<std::vector<int>> tt_shared = tt_src.shared_clone();
+	tt_src.clone_into( tt_shared );
+	EXPECT_FALSE( tt_src.is_locked() );
+
+	obj_mutex<std::vector<int>> tt_moved = std::move( tt_src );
+	EXPECT_THROW( tt_src.clone_into( tt_dst ), std::logic_error );
+	EXPECT_THROW( tt_dst.clone_into( tt_src ), std::logic_error );
+
+	return;
+}
+
+TEST( ObjectMutex, clone_into_does_not_deadlock )
+{
+	obj_mutex<int> tt_a( 1 );
+	obj_mutex<int> tt_b( 2 );
+
+	constexpr int loop_num = 10000;
+	auto          copier   = []( obj_mutex<int>& from, obj_mutex<int>& to ) {
+		for ( int i = 0; i < loop_num; i++ ) {
+			from.clone_into( to );
+		}
+	};
+	std::thread t1( copier, std::ref( tt_a ), std::ref( tt_b ) );
+	std::thread t2( copier, std::ref( tt_b ), std::ref( tt_a ) );
+	t1.join();
+	t2.join();
+
+	EXPECT_EQ( tt_a.lock_get().ref(), tt_b.lock_get().ref() );
+
+	return;
+}
+
+TEST( ObjectMutex, clone_with_allocator )
+{
+	int count = 0;
+	{
+		obj_mutex<test_class1> tt1( 1, 2 );
+		obj_mutex<test_class1> tt2 = tt1.clone( std::allocator_arg, test_counting_allocator<test_class1>( &count ) );
+		EXPECT_EQ( 1, count );
+		EXPECT_EQ( 2, tt2.lock_get().ref().b );
+
+		obj_mutex<test_class1, std::mutex, inline_storage>    tt_inline( 3, 4 );
+		obj_mutex<test_class1, std::mutex, intrusive_storage> tt3 =
+			tt_inline.clone<test_class1, std::mutex, intrusive_storage>( std::allocator_arg, test_counting_allocator<char>( &count ) );
+		EXPECT_EQ( 2, count );
+		EXPECT_EQ( 3, tt3.lock_get().ref().a );
+	}
+	EXPECT_EQ( 0, count );
+
+#if defined( __cpp_lib_memory_resource )
+	std::pmr::monotonic_buffer_resource  pool;
+	std::pmr::polymorphic_allocator<int> alloc( &pool );
+	obj_mutex<int>                       tt_int( 11 );
+	obj_mutex<int>                       tt_int_clone = tt_int.clone( std::allocator_arg, alloc );
+	EXPECT_EQ( 11, tt_int_clone.lock_get().ref() );
+#endif
+
+	return;
+}
+
+struct is_callable_fetch_update_impl {
+	template <typename T>
+	static auto check( obj_mutex<T>* p ) -> decltype( p->load(), std::true_type() );
+
+	template <typename T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T>
+struct is_callable_fetch_update : decltype( is_callable_fetch_update_impl::check<T>( nullptr ) ) {};
+
+TEST( ObjectMutex, fetch_update_is_available_only_for_lock_free_atomic )
+{
+	static_assert( is_callable_fetch_update<std::atomic<int>>::value, "should be callable with std::atomic<int>" );
+	static_assert( is_callable_fetch_update<std::atomic<std::uint64_t>>::value, "should be callable with std::atomic<std::uint64_t>" );
+	static_assert( !is_callable_fetch_update<int>::value, "should not be callable with int" );
+	static_assert( !is_callable_fetch_update<test_class1>::value, "should not be callable with class" );
+	return;
+}
+
+TEST( ObjectMutex, fetch_update_and_load )
+{
+	obj_mutex<std::atomic<int>>                             tt( 0 );
+	obj_mutex<std::atomic<int>, std::mutex, inline_storage> tt_inline( 0 );
+
+	constexpr int            loop_num   = 10000;
+	constexpr int            thread_num = 4;
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < thread_num; i++ ) {
+		threads.emplace_back( [&tt, &tt_inline]() {
+			for ( int j = 0; j < loop_num; j++ ) {
+				tt.fetch_update( []( int v ) { return v + 2; } );
+				tt_inline.fetch_update( []( int v ) { return v + 1; }, std::memory_order_relaxed );
+				if ( ( j % 100 ) == 0 ) {
+					// the accessor is also available for the code that needs the exclusive lock
+					auto acc = tt.lock_get();
+					acc.ref().fetch_add( 1 );
+				}
+			}
+		} );
+	}
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	EXPECT_EQ( thread_num * ( loop_num * 2 + loop_num / 100 ), tt.load() );
+	EXPECT_EQ( thread_num * loop_num, tt_inline.load( std::memory_order_acquire ) );
+	EXPECT_EQ( thread_num * loop_num, tt_inline.fetch_update( []( int v ) { return v * 2; } ) );
+	EXPECT_EQ( thread_num * loop_num * 2, tt_inline.lock_get().ref().load() );
+
+	obj_mutex<std::atomic<int>> tt2 = std::move( tt );
+	EXPECT_THROW( tt.load(), std::logic_error );
+	EXPECT_THROW( tt.fetch_update( []( int v ) { return v; } ), std::logic_error );
+
+	return;
+}
+
+struct test_projection_target {
+	int              a;
+	std::vector<int> v;
+};
+
+TEST( ObjectMutex, project_and_map )
+{
+	obj_mutex<test_projection_target> tt( test_projection_target { 1, { 10, 20 } } );
+
+	{
+		auto acc_a = tt.lock_get().project( &test_projection_target::a );
+		static_assert( std::is_same<decltype( acc_a ), obj_mutex<int>::single_accessor>::value, "should be accessor of int" );
+		acc_a.ref()++;
+
+		std::thread t( [&tt]() { EXPECT_FALSE( tt.try_lock_get().valid() ); } );   // the lock is moved into acc_a
+		t.join();
+	}
+	EXPECT_EQ( 2, tt.lock_get().ref().a );
+
+	{
+		auto acc   = tt.lock_get();
+		auto acc_e = std::move( acc ).map( []( test_projection_target& d ) -> int& { return d.v[1]; } );
+		EXPECT_FALSE( acc.valid() );
+		EXPECT_EQ( 20, acc_e.ref() );
+		acc_e.ref() = 21;
+		EXPECT_THROW( std::move( acc ).project( &test_projection_target::a ), std::logic_error );
+	}
+	EXPECT_EQ( 21, tt.lock_get().ref().v[1] );
+
+	const obj_mutex<test_projection_target>& ctt   = tt;
+	auto                                     acc_c = ctt.lock_get().project( &test_projection_target::v );
+	static_assert( std::is_same<decltype( acc_c.ref() ), const std::vector<int>&>::value, "should be const" );
+	EXPECT_EQ( 2U, acc_c.ref().size() );
+
+	return;
+}
+
+TEST( ObjectMutex, InlineStorage_project_to_base_member )
+{
+	obj_mutex<test_classB, std::mutex, inline_storage> tt( 3 );
+
+	{
+		auto acc = tt.lock_get().project( &test_classA::a );
+		acc.ref() = 5;
+	}
+	auto acc_b = tt.lock_get().project( &test_classB::b );
+	EXPECT_EQ( 3, acc_b.ref() );
+	acc_b = obj_mutex<int, std::mutex, inline_storage>::single_accessor( std::move( acc_b ) );
+	EXPECT_EQ( 3, acc_b.ref() );
+	acc_b = std::move( acc_b ).map( []( int& b ) -> int& { return b; } );
+	EXPECT_EQ( 3, acc_b.ref() );
+
+	return;
+}
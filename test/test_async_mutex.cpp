@@ -0,0 +1,186 @@
+#include "object_async_mutex.hpp"
+
+#if defined( OBJECT_ASYNC_MUTEX_HPP_ ) && defined( __cpp_impl_coroutine ) && __has_include( <coroutine> )
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "object_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct detached_task {
+	struct promise_type {
+		detached_task get_return_object( void )
+		{
+			return detached_task {};
+		}
+		std::suspend_never initial_suspend( void ) noexcept
+		{
+			return {};
+		}
+		std::suspend_never final_suspend( void ) noexcept
+		{
+			return {};
+		}
+		void return_void( void ) {}
+		void unhandled_exception( void )
+		{
+			std::terminate();
+		}
+	};
+};
+
+struct queue_executor {
+	std::vector<std::coroutine_handle<>>* p_queue_;
+
+	void operator()( std::coroutine_handle<> h ) const
+	{
+		p_queue_->push_back( h );
+	}
+};
+
+detached_task append_by_coroutine( obj_mutex<std::vector<int>, obj_async_mutex>& tt, int v )
+{
+	auto acc = co_await tt.co_lock_get();
+	acc.ref().push_back( v );
+}
+
+detached_task append_by_coroutine_on( obj_mutex<std::vector<int>, obj_async_mutex>& tt, int v, queue_executor ex, bool& is_resumed )
+{
+	auto acc = co_await tt.co_lock_get( ex );
+	is_resumed = true;
+	acc.ref().push_back( v );
+}
+
+#if defined( __GNUC__ )
+__attribute__( ( noinline ) )
+#endif
+std::uintptr_t current_stack_position( void )
+{
+	volatile char marker = 0;
+	return reinterpret_cast<std::uintptr_t>( &marker );
+}
+
+detached_task record_stack_position( obj_mutex<std::vector<int>, obj_async_mutex>& tt, int v, std::uintptr_t& lowest, std::uintptr_t& highest )
+{
+	auto           acc = co_await tt.co_lock_get();
+	std::uintptr_t pos = current_stack_position();
+	lowest             = std::min( lowest, pos );
+	highest            = std::max( highest, pos );
+	acc.ref().push_back( v );
+}
+
+}   // namespace
+
+TEST( ObjAsyncMutex, co_lock_get_without_contention )
+{
+	obj_mutex<std::vector<int>, obj_async_mutex> tt;
+
+	append_by_coroutine( tt, 1 );
+	EXPECT_FALSE( tt.is_locked() );
+	EXPECT_EQ( 1U, tt.lock_get().ref().size() );
+
+	return;
+}
+
+TEST( ObjAsyncMutex, co_lock_get_resumes_in_fifo_order )
+{
+	obj_mutex<std::vector<int>, obj_async_mutex> tt;
+
+	{
+		auto acc = tt.lock_get();
+		append_by_coroutine( tt, 1 );   // suspended, and this thread is not blocked
+		append_by_coroutine( tt, 2 );
+		append_by_coroutine( tt, 3 );
+		EXPECT_TRUE( acc.ref().empty() );
+	}
+	EXPECT_FALSE( tt.is_locked() );
+
+	auto acc = tt.lock_get();
+	ASSERT_EQ( 3U, acc.ref().size() );
+	EXPECT_EQ( 1, acc.ref()[0] );
+	EXPECT_EQ( 2, acc.ref()[1] );
+	EXPECT_EQ( 3, acc.ref()[2] );
+
+	return;
+}
+
+TEST( ObjAsyncMutex, co_lock_get_resumes_on_executor )
+{
+	obj_mutex<std::vector<int>, obj_async_mutex> tt;
+	std::vector<std::coroutine_handle<>>         queue;
+	bool                                         is_resumed = false;
+
+	{
+		auto acc = tt.lock_get();
+		append_by_coroutine_on( tt, 5, queue_executor { &queue }, is_resumed );
+	}
+	EXPECT_FALSE( is_resumed );
+	EXPECT_EQ( 1U, queue.size() );
+	EXPECT_TRUE( tt.is_locked() );   // the lock has been handed over to the coroutine
+
+	std::thread t( [&queue]() { queue[0].resume(); } );
+	t.join();
+	EXPECT_TRUE( is_resumed );
+	EXPECT_FALSE( tt.is_locked() );
+	EXPECT_EQ( 5, tt.lock_get().ref()[0] );
+
+	return;
+}
+
+TEST( ObjAsyncMutex, many_queued_coroutines_do_not_nest_on_the_stack )
+{
+	obj_mutex<std::vector<int>, obj_async_mutex> tt;
+
+	constexpr int  num_waiters = 5000;
+	std::uintptr_t lowest      = UINTPTR_MAX;
+	std::uintptr_t highest     = 0;
+	{
+		auto acc = tt.lock_get();
+		for ( int i = 0; i < num_waiters; i++ ) {
+			record_stack_position( tt, i, lowest, highest );
+		}
+	}
+	EXPECT_FALSE( tt.is_locked() );
+
+	// 待ち手が前の待ち手のunlock()の中でresumeされると、待ち手の数に比例してスタックが深くなる。
+	EXPECT_LT( highest - lowest, 4096U );
+	auto acc = tt.lock_get();
+	ASSERT_EQ( static_cast<std::size_t>( num_waiters ), acc.ref().size() );
+	for ( int i = 0; i < num_waiters; i++ ) {
+		EXPECT_EQ( i, acc.ref()[i] );
+	}
+
+	return;
+}
+
+TEST( ObjAsyncMutex, blocking_lock_and_coroutine_share_the_queue )
+{
+	obj_mutex<std::vector<int>, obj_async_mutex> tt;
+
+	std::thread t;
+	{
+		auto acc = tt.lock_get();
+		append_by_coroutine( tt, 1 );
+		t = std::thread( [&tt]() { tt.lock_get().ref().push_back( 2 ); } );
+		std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );   // wait until the thread is queued after the coroutine
+	}
+	t.join();
+
+	auto acc = tt.lock_get();
+	ASSERT_EQ( 2U, acc.ref().size() );
+	EXPECT_EQ( 1, acc.ref()[0] );
+	EXPECT_EQ( 2, acc.ref()[1] );
+
+	return;
+}
+
+#endif
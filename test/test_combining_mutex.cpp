@@ -0,0 +1,103 @@
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_combining_mutex.hpp"
+#include "object_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+template <typename T>
+struct nop_functor {
+	void operator()( T& ) {}
+};
+
+struct is_callable_apply_impl {
+	template <typename T, typename MTX_T>
+	static auto check( obj_mutex<T, MTX_T>* p ) -> decltype( p->apply( nop_functor<T>() ), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_apply : decltype( is_callable_apply_impl::check<T, MTX_T>( nullptr ) ) {};
+
+class no_default_constructible {
+public:
+	explicit no_default_constructible( int v_arg )
+	  : v( v_arg )
+	{
+	}
+
+	int v;
+};
+
+}   // namespace
+
+TEST( ObjCombiningMutex, apply_is_available_only_for_combining_mutex )
+{
+	static_assert( is_callable_apply<int, obj_combining_mutex<>>::value, "should be callable with obj_combining_mutex" );
+	static_assert( !is_callable_apply<int, std::mutex>::value, "should not be callable with std::mutex" );
+	return;
+}
+
+TEST( ObjCombiningMutex, apply_returns_value_and_exception )
+{
+	obj_mutex<int, obj_combining_mutex<>> tt( 1 );
+
+	EXPECT_EQ( 2, tt.apply( []( int& d ) { return ++d; } ) );
+	tt.apply( []( int& d ) { d += 10; } );
+	EXPECT_EQ( 12, tt.lock_get().ref() );
+
+	no_default_constructible ret = tt.apply( []( int& d ) { return no_default_constructible( d ); } );
+	EXPECT_EQ( 12, ret.v );
+
+	std::unique_ptr<int> up = tt.apply( []( int& d ) { return std::unique_ptr<int>( new int( d ) ); } );
+	EXPECT_EQ( 12, *up );
+
+	EXPECT_THROW( tt.apply( []( int& ) -> int { throw std::runtime_error( "test" ); } ), std::runtime_error );
+	EXPECT_FALSE( tt.is_locked() );
+
+	obj_mutex<int, obj_combining_mutex<>> tt2 = std::move( tt );
+	EXPECT_THROW( tt.apply( []( int& d ) { return d; } ), std::logic_error );
+
+	obj_mutex<std::deque<int>, obj_combining_mutex<obj_spin_mutex>, inline_storage> tt_q;
+	tt_q.apply( []( std::deque<int>& q ) { q.push_back( 1 ); } );
+	EXPECT_EQ( 1U, tt_q.lock_get().ref().size() );
+
+	return;
+}
+
+TEST( ObjCombiningMutex, apply_from_many_threads )
+{
+	obj_mutex<long, obj_combining_mutex<>> tt( 0L );
+
+	constexpr int            loop_num = 10000;
+	constexpr int            num_thr  = 8;
+	std::vector<std::thread> threads;
+	for ( int t = 0; t < num_thr; t++ ) {
+		threads.emplace_back( [&tt, t]() {
+			for ( int i = 0; i < loop_num; i++ ) {
+				if ( ( t == 0 ) && ( ( i % 100 ) == 0 ) ) {
+					tt.lock_get().ref()++;   // mix the direct lock with the combining
+				} else {
+					tt.apply( []( long& d ) { d++; } );
+				}
+			}
+		} );
+	}
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	EXPECT_EQ( static_cast<long>( loop_num ) * num_thr, tt.lock_get().ref() );
+
+	return;
+}
@@ -0,0 +1,134 @@
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_condition_mutex.hpp"
+#include "object_mutex.hpp"
+#include "object_spin_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct is_callable_notify_one_impl {
+	template <typename T, typename MTX_T>
+	static auto check( obj_mutex<T, MTX_T>* p ) -> decltype( p->notify_one(), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_notify_one : decltype( is_callable_notify_one_impl::check<T, MTX_T>( nullptr ) ) {};
+
+struct not_empty {
+	bool operator()( const std::deque<int>& q ) const
+	{
+		return !q.empty();
+	}
+};
+
+struct is_callable_wait_impl {
+	template <typename T, typename MTX_T>
+	static auto check( typename obj_mutex<T, MTX_T>::single_accessor* p ) -> decltype( p->wait( not_empty() ), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_wait : decltype( is_callable_wait_impl::check<T, MTX_T>( nullptr ) ) {};
+
+template <typename MTX_T>
+void producer_consumer( void )
+{
+	obj_mutex<std::deque<int>, MTX_T> tt;
+
+	constexpr int loop_num = 1000;
+	std::thread consumer( [&tt]() {
+		for ( int i = 0; i < loop_num; i++ ) {
+			auto acc = tt.lock_get();
+			acc.wait( []( const std::deque<int>& q ) { return !q.empty(); } );
+			EXPECT_EQ( i, acc.ref().front() );
+			acc.ref().pop_front();
+		}
+	} );
+	for ( int i = 0; i < loop_num; i++ ) {
+		tt.lock_get().ref().push_back( i );
+		tt.notify_one();
+	}
+	consumer.join();
+
+	EXPECT_TRUE( tt.lock_get().ref().empty() );
+}
+
+}   // namespace
+
+TEST( ObjConditionMutex, wait_and_notify_are_available_only_for_condition_mutex )
+{
+	static_assert( is_callable_notify_one<std::deque<int>, obj_condition_mutex<>>::value, "should be callable with obj_condition_mutex" );
+	static_assert( !is_callable_notify_one<std::deque<int>, std::mutex>::value, "should not be callable with std::mutex" );
+	static_assert( is_callable_wait<std::deque<int>, obj_condition_mutex<>>::value, "should be callable with obj_condition_mutex" );
+	static_assert( !is_callable_wait<std::deque<int>, std::mutex>::value, "should not be callable with std::mutex" );
+	static_assert( std::is_same<obj_condition_mutex<std::mutex>::condition_variable_t, std::condition_variable>::value, "std::mutex should use std::condition_variable" );
+	static_assert( std::is_same<obj_condition_mutex<obj_spin_mutex>::condition_variable_t, std::condition_variable_any>::value, "other mutex should use std::condition_variable_any" );
+	return;
+}
+
+TEST( ObjConditionMutex, producer_consumer )
+{
+	producer_consumer<obj_condition_mutex<std::mutex>>();
+	producer_consumer<obj_condition_mutex<obj_spin_mutex>>();
+	return;
+}
+
+TEST( ObjConditionMutex, wait_for_and_wait_until )
+{
+	obj_mutex<std::deque<int>, obj_condition_mutex<std::timed_mutex>> tt;
+
+	{
+		auto acc = tt.lock_get();
+		EXPECT_FALSE( acc.wait_for( std::chrono::milliseconds( 1 ), not_empty() ) );
+		EXPECT_FALSE( acc.wait_until( std::chrono::steady_clock::now() + std::chrono::milliseconds( 1 ), not_empty() ) );
+		EXPECT_TRUE( acc.valid() );
+		acc.ref().push_back( 1 );   // the lock is held after the timeout
+	}
+	EXPECT_TRUE( tt.try_lock_get_for( std::chrono::milliseconds( 1 ) ).valid() );
+
+	std::thread producer( [&tt]() {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+		tt.lock_get().ref().push_back( 2 );
+		tt.notify_all();
+	} );
+	{
+		auto acc = tt.lock_get();
+		EXPECT_TRUE( acc.wait_for( std::chrono::seconds( 10 ), []( const std::deque<int>& q ) { return q.size() == 2; } ) );
+	}
+	producer.join();
+
+	return;
+}
+
+TEST( ObjConditionMutex, wait_keeps_the_lock_by_exception )
+{
+	obj_mutex<std::deque<int>, obj_condition_mutex<>, inline_storage> tt;
+
+	{
+		auto acc = tt.lock_get();
+		EXPECT_THROW( acc.wait( []( const std::deque<int>& ) -> bool { throw std::runtime_error( "test" ); } ), std::runtime_error );
+		acc.ref().push_back( 1 );
+	}
+	EXPECT_FALSE( tt.is_locked() );
+	tt.notify_one();
+
+	auto acc       = tt.lock_get();
+	auto acc_moved = std::move( acc );
+	EXPECT_THROW( acc.wait( not_empty() ), std::logic_error );
+
+	return;
+}
@@ -0,0 +1,151 @@
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "object_elided_mutex.hpp"
+#include "object_mutex.hpp"
+#include "object_spin_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct two_counters {
+	long a;
+	long b;
+};
+
+std::uint64_t retired_fallbacks = 0;
+
+void elision_retire_callback( const obj_elision_stats& st )
+{
+	retired_fallbacks += st.fallbacks;
+}
+
+}   // namespace
+
+TEST( ObjElidedMutex, lock_get_and_stats )
+{
+	obj_mutex<int, obj_elided_mutex<>> tt( 1 );
+
+	tt.lock_get().ref()++;
+	tt.with_lock( []( int& d ) { d++; } );
+	EXPECT_EQ( 3, tt.lock_get().ref() );
+
+	obj_elision_stats st = tt.stats();
+	EXPECT_EQ( st.id, tt.shared_clone().stats().id );
+	if ( !obj_elided_mutex<>::htm_enabled() ) {
+		EXPECT_EQ( 0U, st.aborts );
+		EXPECT_EQ( 3U, st.fallbacks );
+	}
+
+	return;
+}
+
+TEST( ObjElidedMutex, mutual_exclusion )
+{
+	obj_mutex<two_counters, obj_elided_mutex<obj_spin_mutex>> tt( two_counters { 0, 0 } );
+
+	constexpr int            loop_num   = 10000;
+	constexpr int            thread_num = 4;
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < thread_num; i++ ) {
+		threads.emplace_back( [&tt, i]() {
+			for ( int j = 0; j < loop_num; j++ ) {
+				auto acc = tt.lock_get();
+				if ( ( i % 2 ) == 0 ) {
+					acc.ref().a++;
+				} else {
+					acc.ref().b++;
+				}
+			}
+		} );
+	}
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	auto acc = tt.lock_get();
+	EXPECT_EQ( loop_num * thread_num / 2, acc.ref().a );
+	EXPECT_EQ( loop_num * thread_num / 2, acc.ref().b );
+
+	return;
+}
+
+TEST( ObjElidedMutex, accessor_move_assignment_releases_the_old_lock )
+{
+	obj_mutex<int, obj_elided_mutex<>> tt1( 1 );
+	obj_mutex<int, obj_elided_mutex<>> tt2( 2 );
+
+	auto acc = tt1.lock_get();
+	acc      = tt2.lock_get();
+	EXPECT_EQ( 2, acc.ref() );
+	acc.ref()++;
+
+	std::thread t( [&tt1]() { tt1.lock_get().ref()++; } );
+	t.join();   // tt1 has been released by the move-assignment
+	EXPECT_EQ( 2, tt1.lock_get().ref() );
+
+	{
+		auto acc_moved = std::move( acc );
+	}
+	EXPECT_EQ( 3, tt2.lock_get().ref() );
+
+	return;
+}
+
+TEST( ObjElidedMutex, try_lock_get )
+{
+	obj_mutex<int, obj_elided_mutex<>> tt( 1 );
+
+	{
+		auto acc = tt.try_lock_get();
+		ASSERT_TRUE( acc.valid() );
+		acc.ref()++;
+	}
+	EXPECT_EQ( 2, tt.lock_get().ref() );
+
+	if ( !obj_elided_mutex<>::htm_enabled() ) {
+		// with the lock elision, try_lock() by other thread may succeed while the lock is elided.
+		auto acc = tt.lock_get();
+		bool ret = true;
+		std::thread t( [&tt, &ret]() { ret = tt.try_lock_get().valid(); } );
+		t.join();
+		EXPECT_FALSE( ret );
+	}
+
+	return;
+}
+
+TEST( ObjElidedMutex, registry )
+{
+	obj_mutex_stats_registry::set_elision_retire_callback( &elision_retire_callback );
+	retired_fallbacks = 0;
+
+	std::uint64_t fallbacks_of_tt = 0;
+	{
+		obj_mutex<int, obj_elided_mutex<>, intrusive_storage> tt( 0 );
+		for ( int i = 0; i < 5; i++ ) {
+			tt.lock_get().ref()++;
+		}
+
+		std::size_t n = 0;
+		obj_mutex_stats_registry::for_each_elision( [&n, &tt]( const obj_elision_stats& st ) {
+			if ( st.id == tt.stats().id ) {
+				n++;
+				EXPECT_EQ( tt.stats().fallbacks, st.fallbacks );
+			}
+		} );
+		EXPECT_EQ( 1U, n );
+		fallbacks_of_tt = tt.stats().fallbacks;
+		if ( !obj_elided_mutex<>::htm_enabled() ) {
+			EXPECT_EQ( 5U, fallbacks_of_tt );
+		}
+	}
+	EXPECT_EQ( fallbacks_of_tt, retired_fallbacks );
+
+	obj_mutex_stats_registry::set_elision_retire_callback( nullptr );
+
+	return;
+}
@@ -0,0 +1,99 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "object_elided_mutex.hpp"
+#include "object_mutex.hpp"
+#include "object_spin_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+// This file is built with -mrtm into the separated executable, so that the code path of the transaction is compiled.
+// The CPU that runs this test may not support RTM. In that case, obj_elided_mutex uses the fallback lock at run time.
+#if !defined( OBJECT_MUTEX_HTM_RTM )
+#error "test_elided_mutex_rtm.cpp should be compiled with -mrtm"
+#endif
+
+namespace {
+
+struct two_counters {
+	long a;
+	long b;
+};
+
+template <typename STORAGE_T>
+void check_mutual_exclusion( void )
+{
+	obj_mutex<two_counters, obj_elided_mutex<obj_spin_mutex>, STORAGE_T> tt( two_counters { 0, 0 } );
+
+	constexpr int            loop_num   = 10000;
+	constexpr int            thread_num = 4;
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < thread_num; i++ ) {
+		threads.emplace_back( [&tt, i]() {
+			for ( int j = 0; j < loop_num; j++ ) {
+				auto acc = tt.lock_get();
+				if ( ( i % 2 ) == 0 ) {
+					acc.ref().a++;
+				} else {
+					acc.ref().b++;
+				}
+			}
+		} );
+	}
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	auto acc = tt.lock_get();
+	EXPECT_EQ( loop_num * thread_num / 2, acc.ref().a );
+	EXPECT_EQ( loop_num * thread_num / 2, acc.ref().b );
+
+	obj_elision_stats st = tt.stats();
+	EXPECT_LE( st.conflict_aborts, st.aborts );
+	EXPECT_LE( st.capacity_aborts, st.aborts );
+	EXPECT_LE( st.lock_busy_aborts, st.aborts );
+	if ( !obj_elided_mutex<obj_spin_mutex>::htm_enabled() ) {
+		EXPECT_EQ( 0U, st.aborts );
+	}
+}
+
+}   // namespace
+
+TEST( ObjElidedMutexRtm, mutual_exclusion_shared_storage )
+{
+	check_mutual_exclusion<shared_storage>();
+	return;
+}
+
+TEST( ObjElidedMutexRtm, mutual_exclusion_intrusive_storage )
+{
+	check_mutual_exclusion<intrusive_storage>();
+	return;
+}
+
+TEST( ObjElidedMutexRtm, mutual_exclusion_inline_storage )
+{
+	check_mutual_exclusion<inline_storage>();
+	return;
+}
+
+TEST( ObjElidedMutexRtm, try_lock_get_and_registry )
+{
+	obj_mutex<int, obj_elided_mutex<>> tt( 1 );
+
+	{
+		auto acc = tt.try_lock_get();
+		ASSERT_TRUE( acc.valid() );
+		acc.ref()++;
+	}
+	EXPECT_EQ( 2, tt.lock_get().ref() );
+
+	std::size_t n = 0;
+	obj_mutex_stats_registry::for_each_elision( [&n, &tt]( const obj_elision_stats& st ) {
+		if ( st.id == tt.stats().id ) n++;
+	} );
+	EXPECT_EQ( 1U, n );
+
+	return;
+}
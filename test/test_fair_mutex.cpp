@@ -0,0 +1,97 @@
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_fair_mutex.hpp"
+#include "object_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct is_callable_lock_get_with_priority_impl {
+	template <typename T, typename MTX_T>
+	static auto check( obj_mutex<T, MTX_T>* p ) -> decltype( p->lock_get( obj_lock_priority::high ), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_lock_get_with_priority : decltype( is_callable_lock_get_with_priority_impl::check<T, MTX_T>( nullptr ) ) {};
+
+template <typename MTX_T>
+void wait_for_waiters( const MTX_T& mtx, std::size_t n )
+{
+	while ( mtx.num_waiters() < n ) {
+		std::this_thread::yield();
+	}
+}
+
+}   // namespace
+
+TEST( ObjFairMutex, lock_get_with_priority_is_available_only_for_priority_lockable )
+{
+	static_assert( is_callable_lock_get_with_priority<int, obj_fair_mutex>::value, "should be callable with obj_fair_mutex" );
+	static_assert( !is_callable_lock_get_with_priority<int, std::mutex>::value, "should not be callable with std::mutex" );
+	return;
+}
+
+TEST( ObjFairMutex, handoff_order_is_fifo_per_priority )
+{
+	obj_fair_mutex   mtx;
+	std::vector<int> order;
+
+	std::vector<std::thread> threads;
+	mtx.lock();
+	const obj_lock_priority prios[] = { obj_lock_priority::normal, obj_lock_priority::low, obj_lock_priority::normal, obj_lock_priority::high };
+	for ( int i = 0; i < 4; i++ ) {
+		obj_lock_priority prio = prios[i];
+		threads.emplace_back( [&mtx, &order, i, prio]() {
+			mtx.lock( prio );
+			order.push_back( i );
+			mtx.unlock();
+		} );
+		wait_for_waiters( mtx, static_cast<std::size_t>( i + 1 ) );
+	}
+	EXPECT_FALSE( mtx.try_lock() );
+	mtx.unlock();
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	EXPECT_EQ( ( std::vector<int> { 3, 0, 2, 1 } ), order );
+	EXPECT_TRUE( mtx.try_lock() );
+	mtx.unlock();
+
+	return;
+}
+
+TEST( ObjFairMutex, lock_get_with_priority )
+{
+	obj_mutex<int, obj_fair_mutex>                 tt( 0 );
+	obj_mutex<int, obj_fair_mutex, inline_storage> tt_inline( 0 );
+
+	constexpr int            loop_num = 10000;
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < 4; i++ ) {
+		threads.emplace_back( [&tt, &tt_inline, i]() {
+			obj_lock_priority prio = ( i == 0 ) ? obj_lock_priority::high : obj_lock_priority::normal;
+			for ( int j = 0; j < loop_num; j++ ) {
+				tt.lock_get( prio ).ref()++;
+				tt_inline.with_lock( []( int& d ) { d++; } );
+			}
+		} );
+	}
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	EXPECT_EQ( loop_num * 4, tt.lock_get().ref() );
+	EXPECT_EQ( loop_num * 4, tt_inline.lock_get( obj_lock_priority::low ).ref() );
+	const obj_mutex<int, obj_fair_mutex>& ctt = tt;
+	EXPECT_EQ( loop_num * 4, ctt.lock_get( obj_lock_priority::low ).ref() );
+
+	return;
+}
@@ -0,0 +1,160 @@
+#include <chrono>
+#include <mutex>
+#if __cplusplus >= 201402L
+#include <shared_mutex>
+#endif
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_instrumented_mutex.hpp"
+#include "object_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct is_callable_stats_impl {
+	template <typename T, typename MTX_T>
+	static auto check( obj_mutex<T, MTX_T>* p ) -> decltype( p->stats(), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_stats : decltype( is_callable_stats_impl::check<T, MTX_T>( nullptr ) ) {};
+
+std::uint64_t retired_acquisitions = 0;
+
+void retire_callback( const obj_mutex_stats& st )
+{
+	retired_acquisitions += st.acquisitions;
+}
+
+int nested_retire_count = 0;
+
+void nested_retire_callback( const obj_mutex_stats& )
+{
+	nested_retire_count++;
+	if ( nested_retire_count == 1 ) {
+		// construct and destruct an instrumented mutex in the callback. this calls this callback again.
+		obj_mutex<int, obj_instrumented_mutex<std::mutex>> tt_in_callback( 0 );
+		tt_in_callback.with_lock( []( int& d ) { d++; } );
+	}
+}
+
+}   // namespace
+
+TEST( ObjInstrumentedMutex, stats_is_available_only_for_instrumented_mutex )
+{
+	static_assert( is_callable_stats<int, obj_instrumented_mutex<std::mutex>>::value, "should be callable with obj_instrumented_mutex" );
+	static_assert( !is_callable_stats<int, std::mutex>::value, "should not be callable with std::mutex" );
+	return;
+}
+
+TEST( ObjInstrumentedMutex, count_acquisitions_and_hold_time )
+{
+	obj_mutex<int, obj_instrumented_mutex<std::mutex>> tt( 1 );
+	obj_mutex<int, obj_instrumented_mutex<std::mutex>> tt2 = tt.shared_clone();
+
+	{
+		auto acc = tt.lock_get();
+		std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+	}
+	tt2.with_lock( []( int& d ) { d++; } );
+	EXPECT_FALSE( tt.is_locked() );   // is_locked() also acquires by try_lock
+
+	obj_mutex_stats st = tt.stats();
+	EXPECT_EQ( 3U, st.acquisitions );
+	EXPECT_EQ( 0U, st.contended );
+	EXPECT_GE( st.max_hold, std::chrono::milliseconds( 2 ) );
+	EXPECT_EQ( st.id, tt2.stats().id );
+
+	obj_mutex<int, obj_instrumented_mutex<std::mutex>> tt3 = std::move( tt2 );
+	EXPECT_THROW( tt2.stats(), std::logic_error );
+
+	return;
+}
+
+#if defined( __cpp_lib_shared_timed_mutex )
+TEST( ObjInstrumentedMutex, count_contended_acquisitions )
+{
+	obj_mutex<int, obj_instrumented_mutex<std::shared_timed_mutex>> tt( 0 );
+
+	std::thread t;
+	{
+		auto acc = tt.lock_get();
+		t        = std::thread( [&tt]() { tt.with_lock( []( int& d ) { d++; } ); } );
+		std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );   // wait until the thread is blocked
+	}
+	t.join();
+
+	{
+		auto read_acc = tt.lock_get_shared();
+		EXPECT_EQ( 1, read_acc.ref() );
+	}
+	EXPECT_TRUE( tt.try_lock_get_for( std::chrono::milliseconds( 1 ) ).valid() );
+
+	obj_mutex_stats st = tt.stats();
+	EXPECT_EQ( 4U, st.acquisitions );
+	EXPECT_EQ( 1U, st.contended );
+	EXPECT_GT( st.total_wait, std::chrono::nanoseconds( 0 ) );
+
+	return;
+}
+#endif
+
+TEST( ObjInstrumentedMutex, registry )
+{
+	obj_mutex_stats_registry::set_retire_callback( &retire_callback );
+	retired_acquisitions = 0;
+
+	const void* p_id_of_hot = nullptr;
+	{
+		std::vector<obj_mutex<int, obj_instrumented_mutex<std::mutex>, intrusive_storage>> vec;
+		vec.emplace_back( 0 );
+		vec.emplace_back( 0 );
+		for ( int i = 0; i < 5; i++ ) {
+			vec[1].with_lock( []( int& d ) { d++; } );
+		}
+		p_id_of_hot = vec[1].stats().id;
+
+		const void*   p_id_of_max = nullptr;
+		std::uint64_t max_acq     = 0;
+		obj_mutex_stats_registry::for_each( [&p_id_of_max, &max_acq]( const obj_mutex_stats& st ) {
+			if ( st.acquisitions > max_acq ) {
+				max_acq     = st.acquisitions;
+				p_id_of_max = st.id;
+			}
+		} );
+		EXPECT_EQ( p_id_of_hot, p_id_of_max );
+		EXPECT_EQ( 5U, max_acq );
+	}
+	EXPECT_EQ( 5U, retired_acquisitions );
+
+	std::size_t n = 0;
+	obj_mutex_stats_registry::for_each( [&n, p_id_of_hot]( const obj_mutex_stats& st ) {
+		if ( st.id == p_id_of_hot ) n++;
+	} );
+	EXPECT_EQ( 0U, n );
+
+	obj_mutex_stats_registry::set_retire_callback( nullptr );
+
+	return;
+}
+
+TEST( ObjInstrumentedMutex, retire_callback_is_able_to_use_instrumented_mutex )
+{
+	obj_mutex_stats_registry::set_retire_callback( &nested_retire_callback );
+	nested_retire_count = 0;
+
+	{
+		obj_mutex<int, obj_instrumented_mutex<std::mutex>> tt( 0 );
+	}
+	EXPECT_EQ( 2, nested_retire_count );
+
+	obj_mutex_stats_registry::set_retire_callback( nullptr );
+
+	return;
+}
@@ -0,0 +1,113 @@
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "object_mutex_map.hpp"
+
+#include "gtest/gtest.h"
+
+TEST( ObjMutexMap, try_emplace_and_lock_get )
+{
+	obj_mutex_map<int, std::string> tt;
+
+	{
+		auto ret1 = tt.try_emplace( 1, "one" );
+		EXPECT_TRUE( ret1.second );
+		EXPECT_TRUE( ret1.first.valid() );
+		EXPECT_EQ( "one", ret1.first.ref() );
+	}
+	EXPECT_TRUE( tt.try_emplace( 2, "two" ).second );
+
+	{
+		auto ret2 = tt.try_emplace( 1, "uno" );
+		EXPECT_FALSE( ret2.second );
+		EXPECT_EQ( "one", ret2.first.ref() );
+		ret2.first.ref() += "!";
+	}
+
+	EXPECT_EQ( "one!", tt.lock_get( 1 ).ref() );
+	EXPECT_EQ( "two", tt.lock_get( 2 ).ref() );
+	EXPECT_THROW( tt.lock_get( 3 ), std::out_of_range );
+	EXPECT_FALSE( tt.find( 3 ).valid() );
+	EXPECT_TRUE( tt.find( 2 ).valid() );
+	EXPECT_EQ( 2U, tt.size() );
+
+	EXPECT_EQ( 1U, tt.erase( 1 ) );
+	EXPECT_EQ( 0U, tt.erase( 1 ) );
+	EXPECT_EQ( 1U, tt.size() );
+
+	return;
+}
+
+TEST( ObjMutexMap, move_only_value )
+{
+	obj_mutex_map<std::string, std::unique_ptr<int>, 4> tt;
+
+	std::string key( "key" );
+	auto        ret = tt.try_emplace( std::move( key ), new int( 5 ) );
+	EXPECT_TRUE( ret.second );
+	EXPECT_EQ( 5, *( ret.first.ref() ) );
+
+	return;
+}
+
+TEST( ObjMutexMap, for_each_shard )
+{
+	obj_mutex_map<int, int, 8> tt;
+	for ( int i = 0; i < 100; i++ ) {
+		tt.try_emplace( i, i );
+	}
+
+	std::atomic<int> sum( 0 );
+	tt.for_each_shard( [&sum]( obj_mutex_map<int, int, 8>::shard_map_t& m ) {
+		for ( auto& kv : m ) {
+			kv.second++;
+			sum += kv.second;
+		}
+	},
+	                   4 );
+	EXPECT_EQ( 5050, sum.load() );
+
+	sum = 0;
+	tt.for_each_shard( [&sum]( obj_mutex_map<int, int, 8>::shard_map_t& m ) {
+		for ( auto& kv : m ) {
+			sum += kv.second;
+		}
+	} );
+	EXPECT_EQ( 5050, sum.load() );
+
+	EXPECT_THROW( tt.for_each_shard( []( obj_mutex_map<int, int, 8>::shard_map_t& ) { throw std::runtime_error( "test" ); }, 0 ), std::runtime_error );
+	EXPECT_EQ( 1, tt.lock_get( 0 ).ref() );   // all shards are unlocked
+
+	return;
+}
+
+TEST( ObjMutexMap, concurrent_increment )
+{
+	obj_mutex_map<int, long> tt;
+
+	constexpr int            num_keys = 64;
+	constexpr int            loop_num = 1000;
+	std::vector<std::thread> threads;
+	for ( int t = 0; t < 4; t++ ) {
+		threads.emplace_back( [&tt]() {
+			for ( int i = 0; i < loop_num; i++ ) {
+				tt.try_emplace( i % num_keys, 0L ).first.ref()++;
+			}
+		} );
+	}
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	long total = 0;
+	for ( int k = 0; k < num_keys; k++ ) {
+		total += tt.lock_get( k ).ref();
+	}
+	EXPECT_EQ( 4 * loop_num, total );
+
+	return;
+}
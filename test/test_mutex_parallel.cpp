@@ -0,0 +1,88 @@
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "object_mutex.hpp"
+#include "object_mutex_parallel.hpp"
+
+#include "gtest/gtest.h"
+
+TEST( ObjMutexParallel, each_element_is_visited_once )
+{
+	std::vector<obj_mutex<int>> objs;
+	for ( int i = 0; i < 1000; i++ ) {
+		objs.emplace_back( i );
+	}
+
+	obj_parallel_policy policy;
+	policy.num_threads = 4;
+	policy.chunk_size  = 7;
+	obj_mutex_parallel_for_each( objs, []( int& v ) { v += 10000; }, policy );
+
+	for ( int i = 0; i < 1000; i++ ) {
+		EXPECT_EQ( i + 10000, objs[i].lock_get().ref() );
+	}
+
+	return;
+}
+
+TEST( ObjMutexParallel, locked_element_is_revisited_without_blocking )
+{
+	std::vector<obj_mutex<int, std::mutex, inline_storage>> objs( 100 );
+	std::atomic<int>                                        visited( 0 );
+	std::atomic<bool>                                       is_locked( false );
+
+	std::thread holder( [&objs, &visited, &is_locked]() {
+		auto acc = objs[3].lock_get();
+		is_locked.store( true );
+		// the worker visits other elements while the element is locked
+		while ( visited.load() < 99 ) {
+			std::this_thread::yield();
+		}
+		acc.ref() = -1;
+	} );
+	while ( !is_locked.load() ) {
+		std::this_thread::yield();
+	}
+
+	obj_parallel_policy policy;
+	policy.num_threads = 1;   // a worker that blocks on objs[3] would never reach the others
+	obj_mutex_parallel_for_each( objs, [&visited]( int& v ) {
+		v += 1;
+		visited++;
+	}, policy );
+	holder.join();
+
+	EXPECT_EQ( 100, visited.load() );
+	EXPECT_EQ( 0, objs[3].lock_get().ref() );
+	EXPECT_EQ( 1, objs[4].lock_get().ref() );
+
+	return;
+}
+
+TEST( ObjMutexParallel, exception_is_rethrown )
+{
+	std::list<obj_mutex<int>> objs;
+	for ( int i = 0; i < 100; i++ ) {
+		objs.emplace_back( i );
+	}
+
+	obj_parallel_policy policy;
+	policy.num_threads = 3;
+	policy.chunk_size  = 1;
+	EXPECT_THROW( obj_mutex_parallel_for_each( objs, []( int& v ) {
+		if ( v == 50 ) {
+			throw std::runtime_error( "test" );
+		}
+	}, policy ),
+	              std::runtime_error );
+
+	std::vector<obj_mutex<int>> empty_objs;
+	obj_mutex_parallel_for_each( empty_objs, []( int& ) {} );
+
+	return;
+}
@@ -0,0 +1,143 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "object_mutex.hpp"
+#include "object_mutex_reclaim.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class reclaim_counted {
+public:
+	reclaim_counted( int a_arg = 0 )
+	  : a( a_arg )
+	{
+		alive++;
+	}
+	virtual ~reclaim_counted()
+	{
+		alive--;
+	}
+
+	int a;
+
+	static std::atomic<int> alive;
+};
+
+std::atomic<int> reclaim_counted::alive( 0 );
+
+class reclaim_counted_derived : public reclaim_counted {
+public:
+	reclaim_counted_derived( int a_arg = 0, int b_arg = 0 )
+	  : reclaim_counted( a_arg )
+	  , b( b_arg )
+	{
+	}
+
+	int b;
+};
+
+struct reclaim_nested {
+	obj_mutex<reclaim_counted, std::mutex, deferred_reclaim_storage> inner;
+};
+
+}   // namespace
+
+TEST( ObjMutexReclaim, destruction_is_deferred_until_reclaim )
+{
+	obj_mutex_reclaim();
+	{
+		obj_mutex<reclaim_counted, std::mutex, deferred_reclaim_storage> tt( 1 );
+		obj_mutex<reclaim_counted, std::mutex, deferred_reclaim_storage> tt2 = tt.shared_clone();
+		EXPECT_EQ( 1, tt2.lock_get().ref().a );
+		EXPECT_EQ( 1, reclaim_counted::alive.load() );
+	}
+	EXPECT_EQ( 1, reclaim_counted::alive.load() );
+
+	EXPECT_EQ( 1U, obj_mutex_reclaim() );
+	EXPECT_EQ( 0, reclaim_counted::alive.load() );
+	EXPECT_EQ( 0U, obj_mutex_reclaim() );
+
+	return;
+}
+
+TEST( ObjMutexReclaim, last_accessor_retires_the_carrier )
+{
+	obj_mutex_reclaim();
+	obj_mutex<reclaim_counted, std::mutex, deferred_reclaim_storage>::single_accessor acc = []() {
+		obj_mutex<reclaim_counted, std::mutex, deferred_reclaim_storage> tt( 2 );
+		return tt.lock_get();
+	}();
+	EXPECT_EQ( 2, acc.ref().a );
+	{
+		auto acc_moved = std::move( acc );
+	}
+	EXPECT_EQ( 1, reclaim_counted::alive.load() );
+	EXPECT_EQ( 1U, obj_mutex_reclaim() );
+	EXPECT_EQ( 0, reclaim_counted::alive.load() );
+
+	return;
+}
+
+TEST( ObjMutexReclaim, up_cast_down_cast_and_allocator )
+{
+	obj_mutex_reclaim();
+	{
+		obj_mutex<reclaim_counted_derived, std::mutex, deferred_reclaim_storage> tt_derived( 3, 4 );
+		obj_mutex<reclaim_counted, std::mutex, deferred_reclaim_storage>         tt_base( std::move( tt_derived ) );
+		EXPECT_EQ( 3, tt_base.lock_get().ref().a );
+		obj_mutex<reclaim_counted_derived, std::mutex, deferred_reclaim_storage> tt_derived2( std::move( tt_base ) );
+		EXPECT_EQ( 4, tt_derived2.lock_get().ref().b );
+
+		obj_mutex<reclaim_counted, std::mutex, deferred_reclaim_storage> tt_alloc( std::allocator_arg, std::allocator<char>(), 5 );
+		EXPECT_EQ( 5, tt_alloc.lock_get().ref().a );
+	}
+	EXPECT_EQ( 2U, obj_mutex_reclaim() );
+	EXPECT_EQ( 0, reclaim_counted::alive.load() );
+
+	return;
+}
+
+TEST( ObjMutexReclaim, nested_carrier_is_reclaimed_by_one_call )
+{
+	obj_mutex_reclaim();
+	{
+		obj_mutex<reclaim_nested, std::mutex, deferred_reclaim_storage> tt;
+		EXPECT_EQ( 1, reclaim_counted::alive.load() );
+	}
+	EXPECT_EQ( 2U, obj_mutex_reclaim() );   // the destructor of the outer retires the inner
+	EXPECT_EQ( 0, reclaim_counted::alive.load() );
+
+	return;
+}
+
+TEST( ObjMutexReclaim, background_reclaimer )
+{
+	obj_mutex_background_reclaimer reclaimer( std::chrono::milliseconds( 1 ) );
+
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < 4; i++ ) {
+		threads.emplace_back( []() {
+			for ( int k = 0; k < 1000; k++ ) {
+				obj_mutex<reclaim_counted, std::mutex, deferred_reclaim_storage> tt( k );
+				tt.lock_get().ref().a++;
+			}
+		} );
+	}
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	for ( int i = 0; i < 5000 && reclaim_counted::alive.load() != 0; i++ ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+	EXPECT_EQ( 0, reclaim_counted::alive.load() );
+
+	return;
+}
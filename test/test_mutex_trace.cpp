@@ -0,0 +1,238 @@
+// The tracing hooks are enabled only in this translation unit. The types of the objects are local to this file,
+// so that the instantiations of obj_mutex with the hooks do not conflict with the ones of other test files.
+#define OBJECT_MUTEX_TRACE 1
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "object_fair_mutex.hpp"
+#include "object_mutex.hpp"
+#include "object_mutex_trace.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct trace_test_data {
+	int v = 0;
+};
+
+std::vector<obj_trace_record> records_of_this_thread( void )
+{
+	std::vector<obj_trace_record> ans;
+	obj_mutex_trace::dump( [&ans]( std::thread::id id, const obj_trace_record& r ) {
+		if ( id == std::this_thread::get_id() ) {
+			ans.push_back( r );
+		}
+	} );
+	return ans;
+}
+
+/**
+ * @brief check every release has the preceding acquired of the same mutex, and every acquired has the preceding acquire
+ */
+void expect_balanced( const std::vector<obj_trace_record>& recs )
+{
+	std::map<const void*, int> acquiring;
+	std::map<const void*, int> holding;
+	for ( const obj_trace_record& r : recs ) {
+		switch ( r.event ) {
+			case obj_trace_event::acquire:
+				acquiring[r.p_mtx]++;
+				break;
+			case obj_trace_event::acquired:
+				EXPECT_GT( acquiring[r.p_mtx], 0 );
+				acquiring[r.p_mtx]--;
+				holding[r.p_mtx]++;
+				break;
+			case obj_trace_event::release:
+				EXPECT_GT( holding[r.p_mtx], 0 );
+				holding[r.p_mtx]--;
+				break;
+		}
+	}
+}
+
+}   // namespace
+
+TEST( ObjMutexTrace, lock_get_and_release_are_recorded )
+{
+	// a new thread starts with an empty ring buffer
+	std::thread t( []() {
+		obj_mutex<trace_test_data> tt1;
+		obj_mutex<trace_test_data> tt2;
+		{
+			auto acc = tt1.lock_get();
+			acc      = tt2.lock_get();   // releases tt1 early
+		}
+
+		std::vector<obj_trace_record> recs = records_of_this_thread();
+		ASSERT_EQ( 6U, recs.size() );
+		EXPECT_EQ( obj_trace_event::acquire, recs[0].event );
+		EXPECT_EQ( obj_trace_event::acquired, recs[1].event );
+		EXPECT_EQ( obj_trace_event::acquire, recs[2].event );
+		EXPECT_EQ( obj_trace_event::acquired, recs[3].event );
+		EXPECT_EQ( obj_trace_event::release, recs[4].event );   // by the move assignment
+		EXPECT_EQ( obj_trace_event::release, recs[5].event );   // by the destructor
+		EXPECT_EQ( recs[0].p_mtx, recs[4].p_mtx );
+		EXPECT_EQ( recs[2].p_mtx, recs[5].p_mtx );
+		EXPECT_NE( recs[0].p_mtx, recs[2].p_mtx );
+		for ( std::size_t i = 1; i < recs.size(); i++ ) {
+			EXPECT_LE( recs[i - 1].timestamp_ns, recs[i].timestamp_ns );
+		}
+	} );
+	t.join();
+
+	return;
+}
+
+TEST( ObjMutexTrace, inline_storage_and_const_lock_get )
+{
+	std::thread t( []() {
+		obj_mutex<trace_test_data, std::mutex, inline_storage>        tt;
+		const obj_mutex<trace_test_data, std::mutex, inline_storage>& ctt = tt;
+		{
+			auto acc = ctt.lock_get();
+			EXPECT_EQ( 0, acc.ref().v );
+		}
+
+		std::vector<obj_trace_record> recs = records_of_this_thread();
+		ASSERT_EQ( 3U, recs.size() );
+		EXPECT_EQ( obj_trace_event::release, recs[2].event );
+	} );
+	t.join();
+
+	return;
+}
+
+TEST( ObjMutexTrace, ring_buffer_keeps_the_latest_records )
+{
+	std::thread t( []() {
+		obj_mutex<trace_test_data> tt;
+		const std::size_t          num = obj_mutex_impl::trace_ring_buffer::capacity;
+		for ( std::size_t i = 0; i < num; i++ ) {
+			tt.lock_get().ref().v++;
+		}
+
+		std::vector<obj_trace_record> recs = records_of_this_thread();
+		ASSERT_EQ( num, recs.size() );
+		EXPECT_EQ( obj_trace_event::release, recs.back().event );
+		EXPECT_EQ( num, static_cast<std::size_t>( tt.lock_get().ref().v ) );
+	} );
+	t.join();
+
+	return;
+}
+
+TEST( ObjMutexTrace, dump_while_recording )
+{
+	obj_mutex<trace_test_data> tt;
+	std::atomic<bool>          done( false );
+
+	std::thread t( [&tt, &done]() {
+		for ( int i = 0; i < 10000; i++ ) {
+			tt.lock_get().ref().v++;
+		}
+		done.store( true );
+	} );
+	std::size_t dumped = 0;
+	while ( !done.load() ) {
+		obj_mutex_trace::dump( [&dumped]( std::thread::id, const obj_trace_record& r ) {
+			EXPECT_NE( nullptr, r.p_mtx );
+			dumped++;
+		} );
+	}
+	t.join();
+	EXPECT_EQ( 10000, tt.lock_get().ref().v );
+
+	return;
+}
+
+TEST( ObjMutexTrace, try_lock_get_records_acquired_only_on_success )
+{
+	std::thread t( []() {
+		obj_mutex<trace_test_data, std::timed_mutex> tt;
+		{
+			auto acc1 = tt.try_lock_get();
+			ASSERT_TRUE( acc1.valid() );
+			std::thread t2( [&tt]() { EXPECT_FALSE( tt.try_lock_get().valid() ); } );
+			t2.join();
+		}
+		{
+			auto acc2 = tt.try_lock_get_for( std::chrono::milliseconds( 1 ) );
+			ASSERT_TRUE( acc2.valid() );
+		}
+		{
+			auto acc3 = tt.try_lock_get_until( std::chrono::steady_clock::now() + std::chrono::milliseconds( 1 ) );
+			ASSERT_TRUE( acc3.valid() );
+		}
+
+		std::vector<obj_trace_record> recs = records_of_this_thread();
+		ASSERT_EQ( 9U, recs.size() );
+		expect_balanced( recs );
+	} );
+	t.join();
+
+	std::thread t3( []() {
+		obj_mutex<trace_test_data, std::mutex, inline_storage> tt;
+
+		auto        acc = tt.lock_get();
+		std::thread t4( [&tt]() {
+			EXPECT_FALSE( tt.try_lock_get().valid() );
+
+			std::vector<obj_trace_record> recs = records_of_this_thread();
+			ASSERT_EQ( 1U, recs.size() );
+			EXPECT_EQ( obj_trace_event::acquire, recs[0].event );
+		} );
+		t4.join();
+	} );
+	t3.join();
+
+	return;
+}
+
+TEST( ObjMutexTrace, priority_lock_is_recorded )
+{
+	std::thread t( []() {
+		obj_mutex<trace_test_data, obj_fair_mutex>                 tt1;
+		obj_mutex<trace_test_data, obj_fair_mutex, inline_storage> tt2;
+		{
+			auto acc = tt1.lock_get( obj_lock_priority::high );
+		}
+		{
+			auto acc = tt2.lock_get( obj_lock_priority::high );
+		}
+
+		std::vector<obj_trace_record> recs = records_of_this_thread();
+		ASSERT_EQ( 6U, recs.size() );
+		expect_balanced( recs );
+	} );
+	t.join();
+
+	return;
+}
+
+#if __cplusplus >= 201402L
+TEST( ObjMutexTrace, lock_get_all_is_recorded )
+{
+	std::thread t( []() {
+		obj_mutex<trace_test_data> tt3;
+		obj_mutex<trace_test_data> tt4;
+		obj_mutex<trace_test_data> tt3_clone = tt3.shared_clone();
+		{
+			auto accs = lock_get_all( tt3, tt4, tt3_clone );
+		}
+
+		std::vector<obj_trace_record> recs = records_of_this_thread();
+		ASSERT_EQ( 6U, recs.size() );   // tt3とtt3_cloneは同じmutexを共有する
+		expect_balanced( recs );
+	} );
+	t.join();
+
+	return;
+}
+#endif
@@ -0,0 +1,168 @@
+#define OBJECT_MUTEX_LOCK_RANK_CHECK 1
+
+#include <mutex>
+#if __cplusplus >= 201402L
+#include <shared_mutex>
+#endif
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "object_mutex.hpp"
+#include "object_ranked_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+TEST( ObjRankedMutex, lock_in_increasing_order )
+{
+	obj_mutex<int, obj_ranked_mutex<1>> tt1( 1 );
+	obj_mutex<int, obj_ranked_mutex<2>> tt2( 2 );
+	obj_mutex<int, obj_ranked_mutex<5>, inline_storage> tt5( 5 );
+
+	{
+		auto acc1 = tt1.lock_get();
+		auto acc2 = tt2.lock_get();
+		auto acc5 = tt5.lock_get();
+		EXPECT_EQ( 8, acc1.ref() + acc2.ref() + acc5.ref() );
+		EXPECT_EQ( 3U, obj_mutex_impl::lock_rank_stack::get().depth() );
+	}
+	EXPECT_EQ( 0U, obj_mutex_impl::lock_rank_stack::get().depth() );
+
+	// the other thread has its own stack
+	auto acc5 = tt5.lock_get();
+	std::thread t( [&tt1]() { EXPECT_EQ( 1, tt1.lock_get().ref() ); } );
+	t.join();
+
+	return;
+}
+
+TEST( ObjRankedMutex, lock_order_violation_throws_before_lock )
+{
+	obj_mutex<int, obj_ranked_mutex<1>> tt1( 1 );
+	obj_mutex<int, obj_ranked_mutex<2>> tt2( 2 );
+	obj_mutex<int, obj_ranked_mutex<2>> tt2b( 2 );
+
+	{
+		auto acc2 = tt2.lock_get();
+		EXPECT_THROW( tt1.lock_get(), std::logic_error );
+		EXPECT_THROW( tt2b.lock_get(), std::logic_error );   // same rank
+		EXPECT_EQ( 1U, obj_mutex_impl::lock_rank_stack::get().depth() );
+	}
+	EXPECT_FALSE( tt1.is_locked() );
+	EXPECT_FALSE( tt2b.is_locked() );
+
+	return;
+}
+
+TEST( ObjRankedMutex, unlock_in_any_order )
+{
+	obj_ranked_mutex<1> mtx1;
+	obj_ranked_mutex<2> mtx2;
+	obj_ranked_mutex<3> mtx3;
+
+	mtx1.lock();
+	mtx2.lock();
+	mtx3.lock();
+	mtx2.unlock();
+	EXPECT_EQ( 2U, obj_mutex_impl::lock_rank_stack::get().depth() );
+	mtx1.unlock();
+	EXPECT_EQ( 1U, obj_mutex_impl::lock_rank_stack::get().depth() );
+	EXPECT_THROW( mtx2.lock(), std::logic_error );   // rank 3 is still held
+	mtx3.unlock();
+	EXPECT_EQ( 0U, obj_mutex_impl::lock_rank_stack::get().depth() );
+
+	obj_mutex<int, obj_ranked_mutex<1>> tt1( 1 );
+	EXPECT_EQ( 1, tt1.lock_get().ref() );
+
+	return;
+}
+
+TEST( ObjRankedMutex, try_lock_is_not_checked )
+{
+	obj_mutex<int, obj_ranked_mutex<1>> tt1( 1 );
+	obj_mutex<int, obj_ranked_mutex<2>> tt2( 2 );
+
+	auto acc2 = tt2.lock_get();
+	auto acc1 = tt1.try_lock_get();
+	EXPECT_TRUE( acc1.valid() );
+	EXPECT_EQ( 2U, obj_mutex_impl::lock_rank_stack::get().depth() );
+
+	return;
+}
+
+TEST( ObjRankedMutex, relock_of_recursive_mutex_is_not_reported )
+{
+	obj_mutex<int, obj_ranked_mutex<1, std::recursive_mutex>> tt1( 1 );
+
+	auto acc1 = tt1.lock_get();
+	acc1      = tt1.lock_get();   // the new lock is acquired before the old one is released
+	EXPECT_EQ( 1U, obj_mutex_impl::lock_rank_stack::get().depth() );
+	EXPECT_EQ( 2, tt1.with_lock( []( int& d ) { return d + 1; } ) );
+
+	return;
+}
+
+namespace {
+
+// 高いrankのobj_mutexを低いアドレスに置き、アドレス順とrank順を逆にする。
+struct ranked_pair {
+	obj_mutex<int, obj_ranked_mutex<2>, inline_storage> tt2 { 2 };
+	obj_mutex<int, obj_ranked_mutex<1>, inline_storage> tt1 { 1 };
+};
+
+}   // namespace
+
+TEST( ObjRankedMutex, clone_into_locks_in_the_order_of_the_rank )
+{
+	ranked_pair rp;
+
+	rp.tt1.clone_into( rp.tt2 );
+	EXPECT_EQ( 1, rp.tt2.lock_get().ref() );
+	rp.tt2.lock_get().ref() = 2;
+	rp.tt2.clone_into( rp.tt1 );
+	EXPECT_EQ( 2, rp.tt1.lock_get().ref() );
+	EXPECT_EQ( 0U, obj_mutex_impl::lock_rank_stack::get().depth() );
+
+	return;
+}
+
+#if __cplusplus >= 201402L
+TEST( ObjRankedMutex, lock_get_all_locks_in_the_order_of_the_rank )
+{
+	ranked_pair rp;
+	ASSERT_LT( static_cast<void*>( &rp.tt2 ), static_cast<void*>( &rp.tt1 ) );
+
+	{
+		auto accs = lock_get_all( rp.tt2, rp.tt1 );
+		EXPECT_EQ( 3, std::get<0>( accs ).ref() + std::get<1>( accs ).ref() );
+		EXPECT_EQ( 2U, obj_mutex_impl::lock_rank_stack::get().depth() );
+	}
+	{
+		auto accs = lock_get_all( rp.tt1, rp.tt2 );
+		EXPECT_EQ( 2U, obj_mutex_impl::lock_rank_stack::get().depth() );
+	}
+	EXPECT_EQ( 0U, obj_mutex_impl::lock_rank_stack::get().depth() );
+
+	obj_mutex<int, obj_ranked_mutex<2>> tt2b( 2 );
+	EXPECT_THROW( lock_get_all( rp.tt2, tt2b ), std::logic_error );   // same rank
+	EXPECT_FALSE( rp.tt2.is_locked() );
+
+	return;
+}
+#endif
+
+#if defined( __cpp_lib_shared_timed_mutex )
+TEST( ObjRankedMutex, shared_lock )
+{
+	obj_mutex<int, obj_ranked_mutex<1, std::shared_timed_mutex>> tt1( 1 );
+	obj_mutex<int, obj_ranked_mutex<2, std::shared_timed_mutex>> tt2( 2 );
+
+	auto acc1 = tt1.lock_get_shared();
+	auto acc2 = tt2.lock_get_shared();
+	EXPECT_EQ( 3, acc1.ref() + acc2.ref() );
+	EXPECT_THROW( tt1.lock_get_shared(), std::logic_error );
+
+	return;
+}
+#endif
@@ -0,0 +1,134 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "object_mutex.hpp"
+#include "object_rcu.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class rcu_test_base {
+public:
+	rcu_test_base( int a_arg = 0 )
+	  : a( a_arg )
+	{
+	}
+
+	int a;
+};
+
+class rcu_test_class : public rcu_test_base {
+public:
+	rcu_test_class( int a_arg = 10, int b_arg = 11 )
+	  : rcu_test_base( a_arg )
+	  , b( b_arg )
+	{
+	}
+
+	int b;
+};
+
+}   // namespace
+
+TEST( ObjRcu, construct_and_snapshot )
+{
+	obj_rcu<rcu_test_class> tt1;
+	EXPECT_EQ( 10, tt1.snapshot()->a );
+	EXPECT_EQ( 11, tt1.snapshot()->b );
+
+	obj_rcu<rcu_test_class> tt2( 1, 2 );
+	EXPECT_EQ( 2, tt2.snapshot()->b );
+
+	std::shared_ptr<const rcu_test_base> sp_base = tt2.snapshot<rcu_test_base>();
+	EXPECT_EQ( 1, sp_base->a );
+
+	obj_mutex<rcu_test_class> tt_mtx( 3, 4 );
+	obj_rcu<rcu_test_class>   tt3( tt_mtx );
+	EXPECT_EQ( 4, tt3.snapshot()->b );
+
+	return;
+}
+
+TEST( ObjRcu, update_does_not_modify_old_snapshot )
+{
+	obj_rcu<rcu_test_class> tt( 1, 2 );
+
+	std::shared_ptr<const rcu_test_class> sp_old = tt.snapshot();
+	tt.update( []( rcu_test_class& d ) { d.b = 20; } );
+	EXPECT_EQ( 2, sp_old->b );
+	EXPECT_EQ( 1, tt.snapshot()->a );
+	EXPECT_EQ( 20, tt.snapshot()->b );
+
+	EXPECT_THROW( tt.update( []( rcu_test_class& d ) { d.b = 30; throw std::runtime_error( "test" ); } ), std::runtime_error );
+	EXPECT_EQ( 20, tt.snapshot()->b );
+
+	tt.emplace( 5, 6 );
+	EXPECT_EQ( 5, tt.snapshot()->a );
+	EXPECT_EQ( 6, tt.snapshot()->b );
+
+	return;
+}
+
+TEST( ObjRcu, clone_to_obj_mutex )
+{
+	obj_rcu<rcu_test_class> tt( 1, 2 );
+
+	obj_mutex<rcu_test_class> tt_mtx = tt.clone();
+	tt_mtx.lock_get().ref().b = 20;
+	EXPECT_EQ( 2, tt.snapshot()->b );
+
+	obj_mutex<rcu_test_class, std::mutex, intrusive_storage> tt_mtx2 = tt.clone<rcu_test_class, std::mutex, intrusive_storage>();
+	EXPECT_EQ( 2, tt_mtx2.lock_get().ref().b );
+
+	return;
+}
+
+TEST( ObjRcu, readers_and_writers )
+{
+	obj_rcu<rcu_test_class> tt( 0, 0 );
+
+	constexpr int     loop_num = 1000;
+	std::atomic<bool> is_running( true );
+	std::atomic<int>  n_inconsistent( 0 );
+
+	std::vector<std::thread> readers;
+	for ( int i = 0; i < 4; i++ ) {
+		readers.emplace_back( [&]() {
+			while ( is_running.load() ) {
+				std::shared_ptr<const rcu_test_class> sp = tt.snapshot();
+				if ( sp->a != sp->b ) {
+					n_inconsistent++;
+				}
+			}
+		} );
+	}
+
+	std::vector<std::thread> writers;
+	for ( int i = 0; i < 2; i++ ) {
+		writers.emplace_back( [&]() {
+			for ( int j = 0; j < loop_num; j++ ) {
+				tt.update( []( rcu_test_class& d ) {
+					d.a++;
+					d.b++;
+				} );
+			}
+		} );
+	}
+	for ( auto& t : writers ) {
+		t.join();
+	}
+	is_running.store( false );
+	for ( auto& t : readers ) {
+		t.join();
+	}
+
+	EXPECT_EQ( 0, n_inconsistent.load() );
+	EXPECT_EQ( loop_num * 2, tt.snapshot()->a );
+
+	return;
+}
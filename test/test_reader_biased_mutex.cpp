@@ -0,0 +1,119 @@
+#include "object_reader_biased_mutex.hpp"
+
+#if __cplusplus >= 201402L
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+static_assert( obj_mutex_impl::is_shared_lockable<obj_reader_biased_mutex<>>::value, "obj_reader_biased_mutex should be SharedLockable" );
+
+TEST( ObjReaderBiasedMutex, reader_of_fast_path_excludes_writer )
+{
+	obj_mutex<int, obj_reader_biased_mutex<>> tt( 1 );
+
+	{
+		auto acc = tt.lock_get_shared();
+		EXPECT_EQ( 1, acc.ref() );
+		std::thread writer( [&tt]() { EXPECT_FALSE( tt.try_lock_get().valid() ); } );
+		writer.join();
+		std::thread reader( [&tt]() { EXPECT_EQ( 1, tt.lock_get_shared().ref() ); } );
+		reader.join();
+	}
+
+	std::thread writer( [&tt]() { tt.lock_get().ref() = 2; } );
+	writer.join();
+	EXPECT_EQ( 2, tt.lock_get_shared().ref() );
+
+	return;
+}
+
+TEST( ObjReaderBiasedMutex, writer_revokes_bias )
+{
+	obj_reader_biased_mutex<> mtx;
+	EXPECT_TRUE( mtx.is_reader_biased() );
+
+	mtx.lock_shared();
+	std::thread writer( [&mtx]() {
+		mtx.lock();   // waits for the reader of the fast path
+		mtx.unlock();
+	} );
+	std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+	mtx.unlock_shared();
+	writer.join();
+	EXPECT_FALSE( mtx.is_reader_biased() );
+
+	// the reader enables the bias again after the inhibit time
+	std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+	mtx.lock_shared();
+	mtx.unlock_shared();
+	EXPECT_TRUE( mtx.is_reader_biased() );
+
+	return;
+}
+
+TEST( ObjReaderBiasedMutex, many_readers_hold_at_same_time )
+{
+	constexpr std::size_t num = obj_mutex_impl::reader_slot_record::max_depth + 4;   // over the record uses the slow path
+
+	std::vector<obj_mutex<int, obj_reader_biased_mutex<>>>                objs( num );
+	std::vector<obj_mutex<int, obj_reader_biased_mutex<>>::read_accessor> accs;
+	for ( auto& o : objs ) {
+		accs.emplace_back( o.lock_get_shared() );
+	}
+	accs.clear();
+	for ( auto& o : objs ) {
+		EXPECT_TRUE( o.try_lock_get().valid() );
+	}
+
+	return;
+}
+
+TEST( ObjReaderBiasedMutex, readers_and_writers )
+{
+	obj_mutex<std::map<int, int>, obj_reader_biased_mutex<>, inline_storage> tt;
+
+	constexpr int            loop_num   = 2000;
+	constexpr int            reader_num = 4;
+	std::atomic<bool>        mismatch( false );
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < reader_num; i++ ) {
+		threads.emplace_back( [&tt, &mismatch]() {
+			for ( int k = 0; k < loop_num; k++ ) {
+				auto acc = tt.lock_get_shared();
+				auto it0 = acc.ref().find( 0 );
+				auto it1 = acc.ref().find( 1 );
+				if ( ( it0 == acc.ref().end() ) != ( it1 == acc.ref().end() ) ) {
+					mismatch.store( true );
+				} else if ( it0 != acc.ref().end() && it0->second != it1->second ) {
+					mismatch.store( true );
+				}
+			}
+		} );
+	}
+	threads.emplace_back( [&tt]() {
+		for ( int k = 0; k < loop_num / 10; k++ ) {
+			auto acc     = tt.lock_get();
+			acc.ref()[0] = k;
+			acc.ref()[1] = k;
+		}
+	} );
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	EXPECT_FALSE( mismatch.load() );
+	EXPECT_EQ( loop_num / 10 - 1, tt.lock_get_shared().ref().at( 1 ) );
+
+	return;
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include <atomic>
+#include <mutex>
+#if __cplusplus >= 201402L
+#include <shared_mutex>
+#endif
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_mutex.hpp"
+#include "object_seqlock_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct quote {
+	long bid;
+	long ask;
+};
+
+struct odd_size_tag {
+	explicit odd_size_tag( char c )
+	  : c_ { c, c, c }
+	{
+	}
+
+	char c_[3];
+};
+
+struct is_callable_optimistic_read_impl {
+	template <typename T, typename MTX_T>
+	static auto check( obj_mutex<T, MTX_T>* p ) -> decltype( p->optimistic_read(), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_optimistic_read : decltype( is_callable_optimistic_read_impl::check<T, MTX_T>( nullptr ) ) {};
+
+}   // namespace
+
+TEST( ObjSeqlockMutex, optimistic_read_is_available_only_for_trivially_copyable )
+{
+	static_assert( is_callable_optimistic_read<quote, obj_seqlock_mutex<>>::value, "should be callable with trivially copyable T" );
+	static_assert( is_callable_optimistic_read<int, obj_seqlock_mutex<>>::value, "should be callable with trivially copyable T" );
+	static_assert( !is_callable_optimistic_read<std::string, obj_seqlock_mutex<>>::value, "should not be callable with non trivially copyable T" );
+	static_assert( !is_callable_optimistic_read<quote, std::mutex>::value, "should not be callable with std::mutex" );
+	return;
+}
+
+TEST( ObjSeqlockMutex, optimistic_read_of_not_default_constructible_and_odd_size )
+{
+	static_assert( !std::is_default_constructible<odd_size_tag>::value, "odd_size_tag should not be default constructible" );
+
+	obj_mutex<odd_size_tag, obj_seqlock_mutex<>> tt( 'a' );
+	tt.publish( []( odd_size_tag& d ) { d.c_[2] = 'b'; } );
+
+	odd_size_tag t = tt.optimistic_read();
+	EXPECT_EQ( 'a', t.c_[0] );
+	EXPECT_EQ( 'a', t.c_[1] );
+	EXPECT_EQ( 'b', t.c_[2] );
+
+	return;
+}
+
+TEST( ObjSeqlockMutex, optimistic_read )
+{
+	obj_mutex<quote, obj_seqlock_mutex<>> tt( quote { 100, 101 } );
+
+	quote q = tt.optimistic_read();
+	EXPECT_EQ( 100, q.bid );
+	EXPECT_EQ( 101, q.ask );
+
+	{
+		auto acc      = tt.lock_get();
+		acc.ref().bid = 200;
+		acc.ref().ask = 201;
+	}
+	EXPECT_EQ( 201, tt.optimistic_read().ask );
+
+	obj_mutex<quote, obj_seqlock_mutex<>> tt2 = std::move( tt );
+	EXPECT_THROW( tt.optimistic_read(), std::logic_error );
+
+#if defined( __cpp_lib_shared_mutex )
+	obj_mutex<int, obj_seqlock_mutex<std::shared_mutex>, inline_storage> tt_int( 11 );
+	EXPECT_EQ( 11, tt_int.lock_get_shared().ref() );
+	tt_int.with_lock( []( int& d ) { d = 12; } );
+	EXPECT_EQ( 12, tt_int.optimistic_read() );
+	tt_int.publish( []( int& d ) { d++; } );
+	EXPECT_EQ( 13, tt_int.optimistic_read() );
+#endif
+
+	return;
+}
+
+TEST( ObjSeqlockMutex, readers_see_consistent_copy )
+{
+	obj_mutex<quote, obj_seqlock_mutex<>> tt( quote { 0, 0 } );
+
+	constexpr long    loop_num = 10000;
+	std::atomic<bool> is_running( true );
+	std::atomic<int>  n_inconsistent( 0 );
+
+	std::vector<std::thread> readers;
+	for ( int i = 0; i < 4; i++ ) {
+		readers.emplace_back( [&]() {
+			while ( is_running.load() ) {
+				quote q = tt.optimistic_read();
+				if ( q.bid != q.ask ) {
+					n_inconsistent++;
+				}
+			}
+		} );
+	}
+
+	std::thread writer( [&]() {
+		for ( long i = 1; i <= loop_num; i++ ) {
+			tt.publish( [i]( quote& d ) {
+				d.bid = i;
+				d.ask = i;
+			} );
+		}
+	} );
+	writer.join();
+	is_running.store( false );
+	for ( auto& t : readers ) {
+		t.join();
+	}
+
+	EXPECT_EQ( 0, n_inconsistent.load() );
+	EXPECT_EQ( loop_num, tt.optimistic_read().bid );
+
+	return;
+}
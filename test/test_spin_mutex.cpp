@@ -0,0 +1,202 @@
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_mutex.hpp"
+#include "object_spin_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class spin_test_class {
+public:
+	spin_test_class( int a_arg = 10, int b_arg = 11 )
+	  : a( a_arg )
+	  , b( b_arg )
+	{
+	}
+
+	int a;
+	int b;
+};
+
+class spin_test_classA {
+public:
+	spin_test_classA( int a_arg = 0 )
+	  : a( a_arg )
+	{
+	}
+	virtual ~spin_test_classA() = default;
+
+	int a;
+};
+
+class spin_test_classB : public spin_test_classA {
+public:
+	spin_test_classB( int b_arg = 0 )
+	  : spin_test_classA()
+	  , b( b_arg )
+	{
+	}
+
+	int b;
+};
+
+template <typename STORAGE_T>
+class ObjSpinMutex : public ::testing::Test {
+};
+
+#if defined( __cpp_aligned_new )
+using spin_storage_types = ::testing::Types<shared_storage, intrusive_storage, cacheline_aligned>;
+#else
+using spin_storage_types = ::testing::Types<shared_storage, intrusive_storage>;
+#endif
+TYPED_TEST_SUITE( ObjSpinMutex, spin_storage_types );
+
+}   // namespace
+
+TEST( ObjSpinMutex, try_lock_and_unlock )
+{
+	obj_spin_mutex mtx;
+
+	EXPECT_TRUE( mtx.try_lock() );
+	EXPECT_FALSE( mtx.try_lock() );
+	mtx.unlock();
+	EXPECT_TRUE( mtx.try_lock() );
+	mtx.unlock();
+
+	std::lock_guard<obj_spin_mutex> lk( mtx );
+	EXPECT_FALSE( mtx.try_lock() );
+}
+
+TYPED_TEST( ObjSpinMutex, Locked )
+{
+	obj_mutex<spin_test_class, obj_spin_mutex, TypeParam> tt;
+
+	{
+		auto locked_data = tt.lock_get();
+		EXPECT_TRUE( tt.is_locked() );
+		EXPECT_EQ( 10, locked_data.ref().a );
+	}
+	EXPECT_FALSE( tt.is_locked() );
+}
+
+TYPED_TEST( ObjSpinMutex, Locked_move )
+{
+	obj_mutex<spin_test_class, obj_spin_mutex, TypeParam> tt11( 11, 12 );
+	obj_mutex<spin_test_class, obj_spin_mutex, TypeParam> tt12( 21, 22 );
+
+	auto locked_data1 = tt11.lock_get();
+	auto locked_data2 = tt12.lock_get();
+
+	locked_data2 = std::move( locked_data1 );
+
+	EXPECT_FALSE( locked_data1.valid() );
+	EXPECT_TRUE( locked_data2.valid() );
+	EXPECT_EQ( 11, locked_data2.ref().a );
+	EXPECT_FALSE( tt12.is_locked() );
+	EXPECT_TRUE( tt11.is_locked() );
+}
+
+TYPED_TEST( ObjSpinMutex, clone_and_shared_clone )
+{
+	obj_mutex<spin_test_class, obj_spin_mutex, TypeParam> tt1( 1, 2 );
+	obj_mutex<spin_test_class, obj_spin_mutex, TypeParam> tt2 = tt1.clone();
+	obj_mutex<spin_test_class, obj_spin_mutex, TypeParam> tt3 = tt1.shared_clone();
+
+	auto locked_acc1 = tt1.lock_get();
+	EXPECT_FALSE( tt2.is_locked() );
+	EXPECT_TRUE( tt3.is_locked() );
+	locked_acc1.ref().a = 10;
+
+	EXPECT_EQ( 1, tt2.lock_get().ref().a );
+}
+
+TYPED_TEST( ObjSpinMutex, up_cast_and_down_cast )
+{
+	obj_mutex<spin_test_classB, obj_spin_mutex, TypeParam> ttB( 21 );
+	ttB.lock_get().ref().a = 20;
+
+	obj_mutex<spin_test_classA, obj_spin_mutex, TypeParam> ttA = std::move( ttB );
+	EXPECT_FALSE( ttB.valid() );
+	EXPECT_EQ( 20, ttA.lock_get().ref().a );
+	EXPECT_EQ( 21, ttA.template lock_get<spin_test_classB>().ref().b );
+
+	obj_mutex<spin_test_classA, obj_spin_mutex, TypeParam> ttA2;
+	EXPECT_THROW( ttA2.template lock_get<spin_test_classB>(), std::bad_cast );
+}
+
+TYPED_TEST( ObjSpinMutex, non_class )
+{
+	obj_mutex<int, obj_spin_mutex, TypeParam> tt_int( 11 );
+	obj_mutex<int, obj_spin_mutex, TypeParam> tt_int1 = tt_int.shared_clone();
+	tt_int1.lock_get().ref()                          = 12;
+
+	EXPECT_EQ( 12, tt_int.lock_get().ref() );
+	EXPECT_EQ( 13, tt_int.with_lock( []( int& v ) { return ++v; } ) );
+}
+
+TYPED_TEST( ObjSpinMutex, contended_increment )
+{
+	constexpr int num_of_threads = 4;
+	constexpr int num_of_loops   = 20000;
+
+	obj_mutex<int, obj_spin_mutex, TypeParam> tt_int( 0 );
+
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < num_of_threads; i++ ) {
+		threads.emplace_back( [&tt_int]() {
+			for ( int j = 0; j < num_of_loops; j++ ) {
+				tt_int.lock_get().ref()++;
+			}
+		} );
+	}
+	for ( auto& th : threads ) {
+		th.join();
+	}
+
+	EXPECT_EQ( num_of_threads * num_of_loops, tt_int.lock_get().ref() );
+}
+
+TEST( ObjSpinMutex, InlineStorage )
+{
+	obj_mutex<int, obj_spin_mutex, inline_storage> tt_int( 11 );
+	static_assert( sizeof( tt_int ) == sizeof( obj_spin_mutex ) + sizeof( int ), "inline_storage with obj_spin_mutex should have no overhead" );
+
+	{
+		auto locked_acc = tt_int.lock_get();
+		EXPECT_TRUE( tt_int.is_locked() );
+	}
+	EXPECT_FALSE( tt_int.is_locked() );
+	EXPECT_EQ( 11, tt_int.lock_get().ref() );
+}
+
+TEST( ObjSpinMutex, waiters_park_while_the_lock_is_held_for_a_long_time )
+{
+	constexpr int num_of_threads = 4;
+
+	obj_mutex<int, obj_spin_mutex> tt_int( 0 );
+
+	std::clock_t             cpu_begin = std::clock();
+	std::vector<std::thread> threads;
+	{
+		auto locked_acc = tt_int.lock_get();
+		for ( int i = 0; i < num_of_threads; i++ ) {
+			threads.emplace_back( [&tt_int]() { tt_int.lock_get().ref()++; } );
+		}
+		std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+	}
+	for ( auto& th : threads ) {
+		th.join();
+	}
+	std::clock_t cpu_end = std::clock();
+
+	EXPECT_EQ( num_of_threads, tt_int.lock_get().ref() );
+	// if the waiters spin or yield until the release, they use 200ms of CPU time at least even on a single core.
+	EXPECT_LT( static_cast<double>( cpu_end - cpu_begin ) / CLOCKS_PER_SEC, 0.05 );
+}
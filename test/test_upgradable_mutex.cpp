@@ -0,0 +1,118 @@
+#include "object_upgradable_mutex.hpp"
+
+#if __cplusplus >= 201402L
+
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "object_mutex.hpp"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct is_callable_lock_get_upgradable_impl {
+	template <typename T, typename MTX_T>
+	static auto check( obj_mutex<T, MTX_T>* p ) -> decltype( p->lock_get_upgradable(), std::true_type() );
+
+	template <typename T, typename MTX_T>
+	static auto check( ... ) -> std::false_type;
+};
+
+template <typename T, typename MTX_T>
+struct is_callable_lock_get_upgradable : decltype( is_callable_lock_get_upgradable_impl::check<T, MTX_T>( nullptr ) ) {};
+
+}   // namespace
+
+TEST( ObjUpgradableMutex, lock_get_upgradable_is_available_only_for_upgradable_mutex )
+{
+	static_assert( is_callable_lock_get_upgradable<int, obj_upgradable_mutex<>>::value, "should be callable with obj_upgradable_mutex" );
+#if defined( __cpp_lib_shared_mutex )
+	static_assert( !is_callable_lock_get_upgradable<int, std::shared_mutex>::value, "should not be callable with std::shared_mutex" );
+#endif
+	static_assert( !is_callable_lock_get_upgradable<int, std::mutex>::value, "should not be callable with std::mutex" );
+	return;
+}
+
+TEST( ObjUpgradableMutex, upgrade_and_downgrade )
+{
+	obj_mutex<std::map<int, int>, obj_upgradable_mutex<>> tt;
+
+	auto acc = tt.lock_get_upgradable();
+	EXPECT_FALSE( acc.is_upgraded() );
+	EXPECT_THROW( acc.mutable_ref(), std::logic_error );
+	EXPECT_TRUE( acc.ref().find( 1 ) == acc.ref().end() );
+
+	// readers are able to run with the upgrade lock
+	std::thread reader( [&tt]() {
+		EXPECT_EQ( 0U, tt.lock_get_shared().ref().size() );
+		EXPECT_FALSE( tt.try_lock_get().valid() );   // the exclusive lock is not available
+	} );
+	reader.join();
+
+	acc.upgrade();
+	EXPECT_TRUE( acc.is_upgraded() );
+	acc.mutable_ref()[1] = 10;
+	acc.upgrade();   // no effect
+
+	acc.downgrade();
+	EXPECT_FALSE( acc.is_upgraded() );
+	std::thread reader2( [&tt]() { EXPECT_EQ( 10, tt.lock_get_shared().ref().at( 1 ) ); } );
+	reader2.join();
+
+	auto acc2 = std::move( acc );
+	EXPECT_FALSE( acc.valid() );
+	EXPECT_THROW( acc.upgrade(), std::logic_error );
+	acc2.upgrade();
+	acc = std::move( acc2 );   // moves the exclusive lock
+	EXPECT_TRUE( acc.is_upgraded() );
+
+	obj_mutex<std::map<int, int>, obj_upgradable_mutex<>> tt_other;
+	acc = tt_other.lock_get_upgradable();   // releases the exclusive lock of tt
+	EXPECT_FALSE( acc.is_upgraded() );
+	std::thread writer( [&tt]() { EXPECT_TRUE( tt.try_lock_get().valid() ); } );
+	writer.join();
+
+	return;
+}
+
+TEST( ObjUpgradableMutex, cache_fill_does_not_lose_the_update )
+{
+	obj_mutex<std::map<int, int>, obj_upgradable_mutex<>, inline_storage> tt;
+
+	constexpr int            key_num    = 100;
+	constexpr int            thread_num = 4;
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < thread_num; i++ ) {
+		threads.emplace_back( [&tt]() {
+			for ( int k = 0; k < key_num; k++ ) {
+				auto acc = tt.lock_get_upgradable();
+				if ( acc.ref().find( k ) == acc.ref().end() ) {
+					acc.upgrade();
+					acc.mutable_ref()[k] = 0;
+					acc.downgrade();
+				}
+				acc.upgrade();
+				acc.mutable_ref()[k]++;
+			}
+		} );
+	}
+	for ( auto& t : threads ) {
+		t.join();
+	}
+
+	auto acc = tt.lock_get_shared();
+	EXPECT_EQ( static_cast<std::size_t>( key_num ), acc.ref().size() );
+	for ( const auto& kv : acc.ref() ) {
+		EXPECT_EQ( thread_num, kv.second );
+	}
+
+	return;
+}
+
+#endif